@@ -66,7 +66,7 @@ cd "$(dirname "$0")"
 
 # define the arrays
 functions=("rmi" "mult" "mwhc")
-tables=("chain" "linear" "cuckoo")
+tables=("chain" "linear" "cuckoo" "swiss")
 datasets=("first" "fb")
 probe=("uniform" "80-20")
 
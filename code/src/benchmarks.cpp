@@ -1,5 +1,8 @@
 #include <iostream>
 #include <string>
+#include <sstream>
+#include <functional>
+#include <filesystem>
 #include <vector>
 #include <algorithm>
 #include <unistd.h>
@@ -14,6 +17,8 @@
     std::string output_dir = "";
     size_t threads;
     std::string filter = "all";
+    std::string model_cache_dir = "";
+    std::string runtime_models = "";
     size_t how_many = dataset::ID_COUNT;
 /* ========================= */
 
@@ -25,7 +30,13 @@ void show_usage() {
     std::cout << "  -o, --output OUTPUT_DIR   Directory that will store the output" << std::endl;
     // std::cout << "  -t, --threads THREADS     Number of threads to use (default: all)" << std::endl;
     std::cout << "  -f, --filter FILTER       Type of benchmark to execute, *comma-separated* (default: all)" << std::endl;
-    std::cout << "                            Options = collisions,gaps,probe[80_20],build,distribution,point[80_20],range[80_20],join,all" << std::endl;    // TODO - add more
+    std::cout << "                            Options = collisions,gaps,probe[80_20],build,distribution,point[80_20],range[80_20],join,probe_size,join_size,probe_batch,tune,probe_miss,probe_threads,bulk_load,all" << std::endl;    // TODO - add more
+    std::cout << "  -M, --models MODELS       Learned functions configured at runtime, added to the collisions and probe experiments" << std::endl;
+    std::cout << "                            *comma-separated*, each one is rmi:<models>, rs:<max_error>[:<radix_bits>] or spline:<max_error>" << std::endl;
+    std::cout << "                            (the in-repo coroutine RMI and spline, not the library RMIHash_* and RadixSplineHash_*)" << std::endl;
+    std::cout << "  -m, --model-cache DIR     Directory storing the trained models, reused across runs (default: none)" << std::endl;
+    std::cout << "                            Only the in-repo models (coroutine RMIs, i.e. rmi:, and HybridHash) are stored: the library ones" << std::endl;
+    std::cout << "                            (RMIHash_*, RadixSplineHash_*, PGMHash_*, MWHC, RecSplit) keep their parameters private, so they are only cached in memory" << std::endl;
     std::cout << "  -h, --help                Display this help message\n" << std::endl;
 }
 int pars_args(const int& argc, char* const* const& argv) {
@@ -76,6 +87,26 @@ int pars_args(const int& argc, char* const* const& argv) {
                 return 2;
             }
         }
+        if (arg == "--models" || arg == "-M") {
+            if (i + 1 < argc) {
+                runtime_models = argv[i + 1];
+                i++; // Skip the next argument
+                continue;
+            } else {
+                std::cerr << "Error: --models requires an argument." << std::endl;
+                return 2;
+            }
+        }
+        if (arg == "--model-cache" || arg == "-m") {
+            if (i + 1 < argc) {
+                model_cache_dir = argv[i + 1];
+                i++; // Skip the next argument
+                continue;
+            } else {
+                std::cerr << "Error: --model-cache requires an argument." << std::endl;
+                return 2;
+            }
+        }
         // if we are here, then the option is unknown 
         std::cerr << "Error: Unknown option " << arg << std::endl;
         show_usage();
@@ -85,30 +116,296 @@ int pars_args(const int& argc, char* const* const& argv) {
 }
 
 template <class HashFn, class ReductionFn = FastModulo>
-void dilate_probe_list(std::vector<bm::BM>& probe_bm_out,dataset::ID id, bm::ProbeType probe_type = bm::ProbeType::UNIFORM) {
+void dilate_probe_list(std::vector<bm::BM>& probe_bm_out,dataset::ID id, bm::ProbeType probe_type = bm::ProbeType::UNIFORM,
+        const std::function<void()>& setup = {}) {
     // Chained
     for (size_t load_perc : chained_lf) {
-        bm::BMtype lambda = [load_perc, probe_type](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
-            bm::probe_throughput<HashFn, ChainedTable<HashFn,ReductionFn>>(ds_obj, writer, load_perc, probe_type);
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
+            bm::probe_throughput<HashFn, ChainedTable<HashFn,ReductionFn>, ReductionFn>(ds_obj, writer, load_perc, probe_type);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+    // Chained, with 32-bit bucket indices
+    for (size_t load_perc : chained_lf) {
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
+            bm::probe_throughput<HashFn, CompactChainedTable<HashFn,ReductionFn>, ReductionFn>(ds_obj, writer, load_perc, probe_type);
         };
         probe_bm_out.push_back({lambda, id});
     }
     // Linear
     for (size_t load_perc : linear_lf) {
-        bm::BMtype lambda = [load_perc, probe_type](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
-            bm::probe_throughput<HashFn, LinearTable<HashFn,ReductionFn>>(ds_obj, writer, load_perc, probe_type);
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
+            bm::probe_throughput<HashFn, LinearTable<HashFn,ReductionFn>, ReductionFn>(ds_obj, writer, load_perc, probe_type);
         };
         probe_bm_out.push_back({lambda, id});
     }
-    // Cuckoo
+    // Robin Hood linear probing, up to 90%
+    for (size_t load_perc : robin_hood_lf) {
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
+            bm::probe_throughput<HashFn, RobinHoodTable<HashFn,ReductionFn>, ReductionFn>(ds_obj, writer, load_perc, probe_type);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+    // Swiss (16 and 32 slot groups)
+    for (size_t load_perc : swiss_lf) {
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
+            bm::probe_throughput<HashFn, SwissTable<HashFn,ReductionFn>, ReductionFn>(ds_obj, writer, load_perc, probe_type);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+    for (size_t load_perc : swiss_lf) {
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
+            bm::probe_throughput<HashFn, SwissTableWide<HashFn,ReductionFn>, ReductionFn>(ds_obj, writer, load_perc, probe_type);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+    // SIMD cuckoo (8 and 16 slot buckets), up to 99%
+    for (size_t load_perc : simd_cuckoo_lf) {
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
+            bm::probe_throughput<HashFn, SimdCuckooTable8<HashFn,ReductionFn>, ReductionFn>(ds_obj, writer, load_perc, probe_type);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+    for (size_t load_perc : simd_cuckoo_lf) {
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
+            bm::probe_throughput<HashFn, SimdCuckooTable<HashFn,ReductionFn>, ReductionFn>(ds_obj, writer, load_perc, probe_type);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+    // Cuckoo (it always reduces to buckets with FastModulo)
+    if constexpr (!std::is_same_v<ReductionFn, FastModulo>)
+        return;
     for (size_t load_perc : cuckoo_lf) {
-        bm::BMtype lambda = [load_perc, probe_type](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::BMtype lambda = [load_perc, probe_type, setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            if (setup) setup();
             bm::probe_throughput<HashFn, CuckooTable<HashFn,FastModulo>>(ds_obj, writer, load_perc, probe_type);
         };
         probe_bm_out.push_back({lambda, id});
     }
 }
 
+/**
+ * Adds the probe experiment of HashFn with the alternative reductions: Fastrange and PowerOfTwo for classic functions,
+ * NoReduction and PowerOfTwo for learned ones (their output is already in the table range, a fastrange would break it).
+*/
+template <class HashFn>
+void dilate_reduction_list(std::vector<bm::BM>& probe_bm_out, dataset::ID id) {
+    if constexpr (_generic_::has_train_method<HashFn>::value)
+        dilate_probe_list<HashFn, NoReduction>(probe_bm_out, id);
+    else dilate_probe_list<HashFn, Fastrange>(probe_bm_out, id);
+    dilate_probe_list<HashFn, PowerOfTwo>(probe_bm_out, id);
+}
+
+template <class HashFn>
+void dilate_runtime_model(std::vector<bm::BMtype>& collision_bm_out, std::vector<bm::BM>& probe_bm_out, const std::function<void()>& setup) {
+    collision_bm_out.push_back([setup](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        setup();
+        bm::collision_stats<HashFn>(ds_obj, writer);
+    });
+    for (dataset::ID id : probe_insert_ds)
+        dilate_probe_list<HashFn>(probe_bm_out, id, bm::ProbeType::UNIFORM, setup);
+}
+
+/**
+ * Adds the learned functions of the --models option to the collisions and probe experiments.
+ * @param models comma-separated list of rmi:<models>, rs:<max_error>[:<radix_bits>] or spline:<max_error>
+ * @return false if the list is malformed
+*/
+bool dilate_runtime_models(const std::string& models, std::vector<bm::BMtype>& collision_bm_out, std::vector<bm::BM>& probe_bm_out) {
+    std::stringstream list(models);
+    std::string model;
+    while (std::getline(list, model, ',')) {
+        std::vector<std::string> fields;
+        std::stringstream parts(model);
+        for (std::string field; std::getline(parts, field, ':');)
+            fields.push_back(field);
+        std::vector<size_t> values;
+        try {
+            for (size_t i = 1; i < fields.size(); i++)
+                values.push_back(std::stoul(fields[i]));
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (fields.empty() || values.empty() || values[0] == 0)
+            return false;
+        if (fields[0] == "rmi" && values.size() == 1) {
+            const size_t count = values[0];
+            dilate_runtime_model<RMIRuntime>(collision_bm_out, probe_bm_out, [count]() { RMIRuntime::set_model_count(count); });
+        } else if (fields[0] == "rs" && values.size() <= 2) {
+            const size_t max_error = values[0];
+            const size_t radix_bits = values.size() == 2 ? values[1] : 18;
+            if (radix_bits == 0 || radix_bits > 30)
+                return false;
+            dilate_runtime_model<RadixSplineRuntime>(collision_bm_out, probe_bm_out, [max_error, radix_bits]() { RadixSplineRuntime::configure(max_error, radix_bits); });
+        } else if (fields[0] == "spline" && values.size() == 1) {
+            const size_t max_error = values[0];
+            dilate_runtime_model<SplineRuntime>(collision_bm_out, probe_bm_out, [max_error]() { SplineRuntime::configure(max_error); });
+        } else return false;
+    }
+    return true;
+}
+
+template <class Candidates>
+void dilate_tuned_probe_list(std::vector<bm::BM>& probe_bm_out, dataset::ID id) {
+    // Chained
+    for (size_t load_perc : chained_lf) {
+        bm::BMtype lambda = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::tuned_probe_throughput<Candidates, ChainedTable>(ds_obj, writer, load_perc, tuner::Table::CHAINED);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+    // Linear
+    for (size_t load_perc : linear_lf) {
+        bm::BMtype lambda = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::tuned_probe_throughput<Candidates, LinearTable>(ds_obj, writer, load_perc, tuner::Table::LINEAR);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+}
+
+template <class HashFn>
+void dilate_probe_batch_list(std::vector<bm::BM>& probe_bm_out, dataset::ID id) {
+    for (size_t load_perc : chained_lf) {
+        bm::BMtype lambda = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_batch<HashFn>(ds_obj, writer, load_perc, bm::ProbeType::UNIFORM);
+        };
+        probe_bm_out.push_back({lambda, id});
+    }
+}
+
+template <class HashFn>
+void dilate_probe_size_list(std::vector<bm::BM>& probe_bm_out, dataset::ID id, size_t sample_size) {
+    bm::BMtype chained = [sample_size](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::probe_size<HashFn, ChainedTable<HashFn>>(ds_obj, writer, sample_size, SWEEP_CHAINED_LF);
+    };
+    bm::BMtype linear = [sample_size](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::probe_size<HashFn, LinearTable<HashFn>>(ds_obj, writer, sample_size, SWEEP_LINEAR_LF);
+    };
+    bm::BMtype cuckoo = [sample_size](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::probe_size<HashFn, CuckooTable<HashFn>>(ds_obj, writer, sample_size, SWEEP_CUCKOO_LF);
+    };
+    probe_bm_out.push_back({chained, id});
+    probe_bm_out.push_back({linear, id});
+    probe_bm_out.push_back({cuckoo, id});
+}
+
+template <class HashFn>
+void dilate_join_size_list(std::vector<bm::BM>& join_bm_out, dataset::ID id, size_t sample_size) {
+    bm::BMtype chained = [sample_size](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::join_size<HashFn, ChainedTable<HashFn>>(ds_obj, writer, sample_size);
+    };
+    bm::BMtype linear = [sample_size](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::join_size<HashFn, LinearTable<HashFn>>(ds_obj, writer, sample_size);
+    };
+    bm::BMtype cuckoo = [sample_size](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::join_size<HashFn, CuckooTable<HashFn>>(ds_obj, writer, sample_size);
+    };
+    join_bm_out.push_back({chained, id});
+    join_bm_out.push_back({linear, id});
+    join_bm_out.push_back({cuckoo, id});
+}
+
+template <class HashFn>
+void dilate_probe_threads_list(std::vector<bm::BM>& probe_bm_out, dataset::ID id) {
+    bm::BMtype lambda = [](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::probe_threads<HashFn, ConcurrentChainedTable<HashFn>>(ds_obj, writer, THREADS_CHAINED_LF);
+    };
+    bm::BMtype sharded = [](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::probe_threads<HashFn, ShardedTable<HashFn>>(ds_obj, writer, THREADS_CHAINED_LF);
+    };
+    probe_bm_out.push_back({lambda, id});
+    probe_bm_out.push_back({sharded, id});
+    for (size_t load_perc : linear_lf) {
+        bm::BMtype linear = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_threads<HashFn, ConcurrentLinearTable<HashFn>>(ds_obj, writer, load_perc);
+        };
+        probe_bm_out.push_back({linear, id});
+    }
+}
+
+// the linear table on HashFn and on the monotone MonotoneFn, against the ordered one on MonotoneFn
+template <class HashFn, class MonotoneFn>
+void dilate_probe_miss_list(std::vector<bm::BM>& probe_bm_out, dataset::ID id) {
+    for (size_t load_perc : probe_miss_lf) {
+        bm::BMtype linear = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_miss<HashFn, LinearTable<HashFn>>(ds_obj, writer, load_perc);
+        };
+        bm::BMtype linear_monotone = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_miss<MonotoneFn, LinearTable<MonotoneFn>>(ds_obj, writer, load_perc);
+        };
+        bm::BMtype ordered = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_miss<MonotoneFn, OrderedLinearTable<MonotoneFn>>(ds_obj, writer, load_perc);
+        };
+        probe_bm_out.push_back({linear, id});
+        probe_bm_out.push_back({linear_monotone, id});
+        probe_bm_out.push_back({ordered, id});
+    }
+}
+
+/**
+ * Adds the tables built from the sorted keys (bulk::BuildMode::BULK_LOAD) to the probe and join experiments.
+ * The compact chained, ordered linear and RMISort tables have their own bulk_load, the third-party ones are filled
+ * with sorted inserts (build_mode "sorted_insert"). The ordered linear table and RMISort (which needs a table as large
+ * as the dataset, so it runs at 100% in both build modes) are only added for learned (monotone) functions.
+*/
+template <class HashFn>
+void dilate_bulk_load_list(std::vector<bm::BM>& bulk_bm_out, dataset::ID id) {
+    constexpr bm::ProbeType probe_type = bm::ProbeType::UNIFORM;
+    constexpr bulk::BuildMode bulk_load = bulk::BuildMode::BULK_LOAD;
+    for (size_t load_perc : chained_lf) {
+        bm::BMtype chained = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_throughput<HashFn, ChainedTable<HashFn>, FastModulo, bulk_load>(ds_obj, writer, load_perc, probe_type);
+        };
+        bm::BMtype compact = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_throughput<HashFn, CompactChainedTable<HashFn>, FastModulo, bulk_load>(ds_obj, writer, load_perc, probe_type);
+        };
+        bulk_bm_out.push_back({chained, id});
+        bulk_bm_out.push_back({compact, id});
+    }
+    for (size_t load_perc : linear_lf) {
+        bm::BMtype linear = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_throughput<HashFn, LinearTable<HashFn>, FastModulo, bulk_load>(ds_obj, writer, load_perc, probe_type);
+        };
+        bulk_bm_out.push_back({linear, id});
+        if constexpr (_generic_::has_train_method<HashFn>::value) {
+            bm::BMtype ordered = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+                bm::probe_throughput<HashFn, OrderedLinearTable<HashFn>, FastModulo, bulk_load>(ds_obj, writer, load_perc, probe_type);
+            };
+            bulk_bm_out.push_back({ordered, id});
+        }
+    }
+    for (size_t load_perc : cuckoo_lf) {
+        bm::BMtype cuckoo = [load_perc](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_throughput<HashFn, CuckooTable<HashFn>, FastModulo, bulk_load>(ds_obj, writer, load_perc, probe_type);
+        };
+        bulk_bm_out.push_back({cuckoo, id});
+    }
+    if constexpr (_generic_::has_train_method<HashFn>::value) {
+        bm::BMtype sort_insert = [](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_throughput<HashFn, RMISortRange<HashFn>>(ds_obj, writer, 100, probe_type);
+        };
+        bm::BMtype sort_bulk = [](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::probe_throughput<HashFn, RMISortRange<HashFn>, FastModulo, bulk_load>(ds_obj, writer, 100, probe_type);
+        };
+        bulk_bm_out.push_back({sort_insert, id});
+        bulk_bm_out.push_back({sort_bulk, id});
+    }
+    bulk_bm_out.push_back({&bm::join_throughput<HashFn, ChainedTable<HashFn>, bulk_load>, id});
+    bulk_bm_out.push_back({&bm::join_throughput<HashFn, CompactChainedTable<HashFn>, bulk_load>, id});
+    bulk_bm_out.push_back({&bm::join_throughput<HashFn, LinearTable<HashFn>, bulk_load>, id});
+    bulk_bm_out.push_back({&bm::join_throughput<HashFn, CuckooTable<HashFn>, bulk_load>, id});
+    if constexpr (_generic_::has_train_method<HashFn>::value)
+        bulk_bm_out.push_back({&bm::join_throughput<HashFn, OrderedLinearTable<HashFn>, bulk_load>, id});
+}
+
 void dilate_function_list(std::vector<bm::BMtype>& bm_out, const bm::BMtemplate _bm_function_, const size_t sizes[], const size_t len) {
     for (size_t i=0; i<len; i++) {
         size_t s = sizes[i];
@@ -127,7 +424,13 @@ void load_bm_list(std::vector<bm::BM>& bm_list,
         const std::vector<bm::BMtype>& collisions_vs_gaps_bm,
         const std::vector<bm::BMtype>& point_vs_range_bm, const std::vector<bm::BMtype>& point_vs_range_pareto_bm,
         const std::vector<bm::BMtype>& range_size_bm, const std::vector<bm::BMtype>& range_size_pareto_bm,
-        const std::vector<bm::BM>& join_bm
+        const std::vector<bm::BM>& join_bm,
+        const std::vector<bm::BM>& probe_size_bm, const std::vector<bm::BM>& join_size_bm,
+        const std::vector<bm::BM>& probe_batch_bm,
+        const std::vector<bm::BM>& tune_bm,
+        const std::vector<bm::BM>& probe_miss_bm,
+        const std::vector<bm::BM>& probe_threads_bm,
+        const std::vector<bm::BM>& bulk_load_bm
     /*TODO - add more*/) {
     std::string part;
     size_t start;
@@ -202,6 +505,48 @@ void load_bm_list(std::vector<bm::BM>& bm_list,
             }
             if (part != "all") continue;
         }
+        if (part == "probe_size" || part == "all") {
+            for (const bm::BM& bm_struct : probe_size_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
+        if (part == "join_size" || part == "all") {
+            for (const bm::BM& bm_struct : join_size_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
+        if (part == "probe_batch" || part == "all") {
+            for (const bm::BM& bm_struct : probe_batch_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
+        if (part == "tune" || part == "all") {
+            for (const bm::BM& bm_struct : tune_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
+        if (part == "probe_miss" || part == "all") {
+            for (const bm::BM& bm_struct : probe_miss_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
+        if (part == "probe_threads" || part == "all") {
+            for (const bm::BM& bm_struct : probe_threads_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
+        if (part == "bulk_load" || part == "all") {
+            for (const bm::BM& bm_struct : bulk_load_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
         if (part == "join" || part == "all") {
             for (const bm::BM& bm_struct : join_bm) {
                 bm_list.push_back(bm_struct);
@@ -235,6 +580,10 @@ int main(int argc, char* argv[]) {
 
     // Create a JsonWriter instance (for the output file)
     JsonOutput writer(output_dir, argv[0], filter);
+    if (model_cache_dir != "") {
+        std::filesystem::create_directories(model_cache_dir);
+        model_cache::Cache::instance().set_directory(model_cache_dir);
+    }
 
     // Benchmark arrays definition
     std::vector<bm::BM> bm_list;
@@ -262,12 +611,29 @@ int main(int argc, char* argv[]) {
         &bm::collision_stats<PGMHash_100>,
         &bm::collision_stats<PGMHash_1k>,
         &bm::collision_stats<PGMHash_100k>,
+        // Hybrid (learned or classic, per segment)
+        &bm::collision_stats<HybridHash_10>,
+        &bm::collision_stats<HybridHash_100>,
+        &bm::collision_stats<HybridHash_1k>,
+        &bm::collision_stats<HybridHash_10k>,
+        &bm::collision_stats<HybridHash_1M>,
+        &bm::collision_stats<HybridHash_10M>,
+        &bm::collision_stats<HybridMurmur_10M>,
         // Classic
         &bm::collision_stats<MURMUR>,
         &bm::collision_stats<MultPrime64>,
         &bm::collision_stats<FibonacciPrime64>,
         &bm::collision_stats<AquaHash>,
         &bm::collision_stats<XXHash3>,
+        // Classic, with the alternative reductions
+        &bm::collision_stats<MURMUR, Fastrange>,
+        &bm::collision_stats<MURMUR, PowerOfTwo>,
+        &bm::collision_stats<MultPrime64, Fastrange>,
+        &bm::collision_stats<MultPrime64, PowerOfTwo>,
+        &bm::collision_stats<FibonacciPrime64, Fastrange>,
+        &bm::collision_stats<FibonacciPrime64, PowerOfTwo>,
+        &bm::collision_stats<XXHash3, Fastrange>,
+        &bm::collision_stats<XXHash3, PowerOfTwo>,
         // Perfect
         &bm::collision_stats<MWHC>,
         &bm::collision_stats<BitMWHC>,
@@ -282,6 +648,18 @@ int main(int argc, char* argv[]) {
     dilate_probe_list<RMIHash_1k>(probe_bm,dataset::ID::WIKI);
     dilate_probe_list<RMIHash_10M>(probe_bm,dataset::ID::FB);
     dilate_probe_list<RMIHash_10M>(probe_bm,dataset::ID::OSM);
+    // ... and with the alternative reductions
+    dilate_reduction_list<RMIHash_10>(probe_bm,dataset::ID::GAP_10);
+    dilate_reduction_list<RMIHash_100>(probe_bm,dataset::ID::NORMAL);
+    dilate_reduction_list<RMIHash_1k>(probe_bm,dataset::ID::WIKI);
+    dilate_reduction_list<RMIHash_10M>(probe_bm,dataset::ID::FB);
+    dilate_reduction_list<RMIHash_10M>(probe_bm,dataset::ID::OSM);
+    // same number of segments as the RMI of each dataset
+    dilate_probe_list<HybridHash_10>(probe_bm,dataset::ID::GAP_10);
+    dilate_probe_list<HybridHash_100>(probe_bm,dataset::ID::NORMAL);
+    dilate_probe_list<HybridHash_1k>(probe_bm,dataset::ID::WIKI);
+    dilate_probe_list<HybridHash_10M>(probe_bm,dataset::ID::FB);
+    dilate_probe_list<HybridHash_10M>(probe_bm,dataset::ID::OSM);
     // for each dataset
     for (dataset::ID id : probe_insert_ds) {
         dilate_probe_list<RadixSplineHash_128>(probe_bm,id);
@@ -289,7 +667,14 @@ int main(int argc, char* argv[]) {
         dilate_probe_list<MURMUR>(probe_bm,id);
         dilate_probe_list<MultPrime64>(probe_bm,id);
         dilate_probe_list<MWHC>(probe_bm,id);
-
+        dilate_reduction_list<MURMUR>(probe_bm,id);
+        dilate_reduction_list<MultPrime64>(probe_bm,id);
+    }
+    // runtime-configured functions
+    if (!dilate_runtime_models(runtime_models, collision_bm, probe_bm)) {
+        std::cerr << "Error: malformed --models list " << runtime_models << std::endl;
+        show_usage();
+        return 1;
     }
     // ---------------- probe PARETO --------------- //
     std::vector<bm::BM> probe_pareto_bm = {};
@@ -314,6 +699,13 @@ int main(int argc, char* argv[]) {
     dilate_function_list(build_bm, &bm::build_time<RadixSplineHash_1k>, build_entries, build_size);
     dilate_function_list(build_bm, &bm::build_time<PGMHash_1k>, build_entries, build_size);
     dilate_function_list(build_bm, &bm::build_time<MWHC>, build_entries, build_size);
+    dilate_function_list(build_bm, &bm::rmi_train_time<RMICoro_100>, build_entries, build_size);
+    dilate_function_list(build_bm, &bm::rmi_train_time<RMICoro_10M>, build_entries, build_size);
+    dilate_function_list(build_bm, &bm::rmi_train_time<RMICoro_100M>, build_entries, build_size);
+    dilate_function_list(build_bm, &bm::partitioned_build_time<PartitionedRMIHash_100>, build_entries, build_size);
+    dilate_function_list(build_bm, &bm::partitioned_build_time<PartitionedRadixSplineHash_1k>, build_entries, build_size);
+    dilate_function_list(build_bm, &bm::partitioned_build_time<PartitionedPGMHash_1k>, build_entries, build_size);
+    dilate_function_list(build_bm, &bm::partitioned_build_time<PartitionedMWHC>, build_entries, build_size);
     // ---------------- collisions-vs-gaps --------------- //
     std::vector<bm::BMtype> collisions_vs_gaps_bm = {};
     size_t lf_size = sizeof(collisions_vs_gaps_lf)/sizeof(collisions_vs_gaps_lf[0]);
@@ -324,22 +716,26 @@ int main(int argc, char* argv[]) {
     dilate_function_list(point_vs_range_bm, &bm::point_vs_range<RMIMonotone,ChainedRange<RMIMonotone>>, point_queries_perc, point_size);
     dilate_function_list(point_vs_range_bm, &bm::point_vs_range<RadixSplineHash_1k,ChainedRange<RadixSplineHash_1k>>, point_queries_perc, point_size);
     dilate_function_list(point_vs_range_bm, &bm::point_vs_range<RMIMonotone,RMISortRange<RMIMonotone>>, point_queries_perc, point_size);
+    dilate_function_list(point_vs_range_bm, &bm::point_vs_range<RMIMonotone,SortedChainedRange<RMIMonotone>>, point_queries_perc, point_size);
     // ---------------- point-vs-range PARETO --------------- //
     std::vector<bm::BMtype> point_vs_range_pareto_bm = {};
     dilate_function_list(point_vs_range_pareto_bm, &bm::point_vs_range_pareto<RMIMonotone,ChainedRange<RMIMonotone>>, point_queries_perc, point_size);
     dilate_function_list(point_vs_range_pareto_bm, &bm::point_vs_range_pareto<RadixSplineHash_1k,ChainedRange<RadixSplineHash_1k>>, point_queries_perc, point_size);
     dilate_function_list(point_vs_range_pareto_bm, &bm::point_vs_range_pareto<RMIMonotone,RMISortRange<RMIMonotone>>, point_queries_perc, point_size);
+    dilate_function_list(point_vs_range_pareto_bm, &bm::point_vs_range_pareto<RMIMonotone,SortedChainedRange<RMIMonotone>>, point_queries_perc, point_size);
     // ---------------- range-size --------------- //
     std::vector<bm::BMtype> range_len_bm = {};
     size_t range_size = sizeof(range_len)/sizeof(range_len[0]);
     dilate_function_list(range_len_bm, &bm::range_throughput<RMIMonotone,ChainedRange<RMIMonotone>>, range_len, range_size);
     dilate_function_list(range_len_bm, &bm::range_throughput<RadixSplineHash_1k,ChainedRange<RadixSplineHash_1k>>, range_len, range_size);
     dilate_function_list(range_len_bm, &bm::range_throughput<RMIMonotone,RMISortRange<RMIMonotone>>, range_len, range_size);
+    dilate_function_list(range_len_bm, &bm::range_throughput<RMIMonotone,SortedChainedRange<RMIMonotone>>, range_len, range_size);
     // ---------------- range-size PARETO --------------- //
     std::vector<bm::BMtype> range_len_pareto_bm = {};
     dilate_function_list(range_len_pareto_bm, &bm::range_throughput_pareto<RMIMonotone,ChainedRange<RMIMonotone>>, range_len, range_size);
     dilate_function_list(range_len_pareto_bm, &bm::range_throughput_pareto<RadixSplineHash_1k,ChainedRange<RadixSplineHash_1k>>, range_len, range_size);
     dilate_function_list(range_len_pareto_bm, &bm::range_throughput_pareto<RMIMonotone,RMISortRange<RMIMonotone>>, range_len, range_size);
+    dilate_function_list(range_len_pareto_bm, &bm::range_throughput_pareto<RMIMonotone,SortedChainedRange<RMIMonotone>>, range_len, range_size);
     
     // ---------------- join --------------- //
     std::vector<bm::BM> join_bm = {};
@@ -347,24 +743,119 @@ int main(int argc, char* argv[]) {
     join_bm.push_back({&bm::join_throughput<RMIHash_1k, ChainedTable<RMIHash_1k>>, dataset::ID::WIKI});
     join_bm.push_back({&bm::join_throughput<RMIHash_1k, LinearTable<RMIHash_1k>>, dataset::ID::WIKI});
     join_bm.push_back({&bm::join_throughput<RMIHash_1k, CuckooTable<RMIHash_1k>>, dataset::ID::WIKI});
+    join_bm.push_back({&bm::join_throughput<RMIHash_1k, SwissTable<RMIHash_1k>>, dataset::ID::WIKI});
+    join_bm.push_back({&bm::join_throughput<RMIHash_1k, ConcurrentChainedTable<RMIHash_1k>>, dataset::ID::WIKI});
     // RMI, fb
     join_bm.push_back({&bm::join_throughput<RMIHash_1M, ChainedTable<RMIHash_1M>>, dataset::ID::FB});
     join_bm.push_back({&bm::join_throughput<RMIHash_1M, LinearTable<RMIHash_1M>>, dataset::ID::FB});
     join_bm.push_back({&bm::join_throughput<RMIHash_1M, CuckooTable<RMIHash_1M>>, dataset::ID::FB});
+    join_bm.push_back({&bm::join_throughput<RMIHash_1M, SwissTable<RMIHash_1M>>, dataset::ID::FB});
+    join_bm.push_back({&bm::join_throughput<RMIHash_1M, ConcurrentChainedTable<RMIHash_1M>>, dataset::ID::FB});
     // the other 2
     for (dataset::ID id : join_ds) {    
         join_bm.push_back({&bm::join_throughput<MultPrime64, ChainedTable<MultPrime64>>, id});
         join_bm.push_back({&bm::join_throughput<MultPrime64, LinearTable<MultPrime64>>, id});
         join_bm.push_back({&bm::join_throughput<MultPrime64, CuckooTable<MultPrime64>>, id});
+        join_bm.push_back({&bm::join_throughput<MultPrime64, SwissTable<MultPrime64>>, id});
+        join_bm.push_back({&bm::join_throughput<MultPrime64, ConcurrentChainedTable<MultPrime64>>, id});
         join_bm.push_back({&bm::join_throughput<MWHC, ChainedTable<MWHC>>, id});
         join_bm.push_back({&bm::join_throughput<MWHC, LinearTable<MWHC>>, id});
         join_bm.push_back({&bm::join_throughput<MWHC, CuckooTable<MWHC>>, id});
+        join_bm.push_back({&bm::join_throughput<MWHC, SwissTable<MWHC>>, id});
+        join_bm.push_back({&bm::join_throughput<MWHC, ConcurrentChainedTable<MWHC>>, id});
+    }
+
+    // ---------------- size sweep --------------- //
+    std::vector<bm::BM> probe_size_bm = {};
+    std::vector<bm::BM> join_size_bm = {};
+    for (dataset::ID id : sweep_ds) {
+        for (size_t s : sweep_sizes) {
+            // RMI, keeping around 100 keys per second level model
+            if (s <= k(3)) {
+                dilate_probe_size_list<RMIHash_10>(probe_size_bm,id,s);
+                dilate_join_size_list<RMIHash_10>(join_size_bm,id,s);
+            } else if (s <= k(30)) {
+                dilate_probe_size_list<RMIHash_100>(probe_size_bm,id,s);
+                dilate_join_size_list<RMIHash_100>(join_size_bm,id,s);
+            } else if (s <= k(300)) {
+                dilate_probe_size_list<RMIHash_1k>(probe_size_bm,id,s);
+                dilate_join_size_list<RMIHash_1k>(join_size_bm,id,s);
+            } else if (s <= M(3)) {
+                dilate_probe_size_list<RMIHash_10k>(probe_size_bm,id,s);
+                dilate_join_size_list<RMIHash_10k>(join_size_bm,id,s);
+            } else if (s <= M(30)) {
+                dilate_probe_size_list<RMIHash_100k>(probe_size_bm,id,s);
+                dilate_join_size_list<RMIHash_100k>(join_size_bm,id,s);
+            } else {
+                dilate_probe_size_list<RMIHash_1M>(probe_size_bm,id,s);
+                dilate_join_size_list<RMIHash_1M>(join_size_bm,id,s);
+            }
+            dilate_probe_size_list<RadixSplineHash_128>(probe_size_bm,id,s);
+            dilate_probe_size_list<PGMHash_100>(probe_size_bm,id,s);
+            dilate_probe_size_list<MURMUR>(probe_size_bm,id,s);
+            dilate_probe_size_list<MultPrime64>(probe_size_bm,id,s);
+            dilate_probe_size_list<MWHC>(probe_size_bm,id,s);
+            dilate_join_size_list<MultPrime64>(join_size_bm,id,s);
+            dilate_join_size_list<MWHC>(join_size_bm,id,s);
+        }
+    }
+
+    // ---------------- probe batch --------------- //
+    std::vector<bm::BM> probe_batch_bm = {};
+    dilate_probe_batch_list<RMIHash_10>(probe_batch_bm,dataset::ID::GAP_10);
+    dilate_probe_batch_list<RMIHash_100>(probe_batch_bm,dataset::ID::NORMAL);
+    dilate_probe_batch_list<RMIHash_1k>(probe_batch_bm,dataset::ID::WIKI);
+    dilate_probe_batch_list<RMIHash_10M>(probe_batch_bm,dataset::ID::FB);
+    dilate_probe_batch_list<RMIHash_10M>(probe_batch_bm,dataset::ID::OSM);
+    // for each dataset
+    for (dataset::ID id : probe_insert_ds) {
+        dilate_probe_batch_list<MURMUR>(probe_batch_bm,id);
+        dilate_probe_batch_list<MultPrime64>(probe_batch_bm,id);
+        dilate_probe_batch_list<FibonacciPrime64>(probe_batch_bm,id);
+    }
+
+    // ---------------- tuned functions --------------- //
+    std::vector<bm::BM> tune_bm = {};
+    for (dataset::ID id : probe_insert_ds)
+        dilate_tuned_probe_list<RMITuningCandidates>(tune_bm,id);
+    for (dataset::ID id : join_ds) {
+        tune_bm.push_back({[](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::tuned_join_throughput<RMITuningCandidates, ChainedTable>(ds_obj, writer, tuner::Table::CHAINED);
+        }, id});
+        tune_bm.push_back({[](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+            bm::tuned_join_throughput<RMITuningCandidates, LinearTable>(ds_obj, writer, tuner::Table::LINEAR);
+        }, id});
     }
 
-    load_bm_list(bm_list, collision_bm, gap_bm, probe_bm, probe_pareto_bm, build_bm, collisions_vs_gaps_bm, point_vs_range_bm, point_vs_range_pareto_bm, range_len_bm, range_len_pareto_bm, join_bm);
+    // ---------------- probe miss --------------- //
+    std::vector<bm::BM> probe_miss_bm = {};
+    dilate_probe_miss_list<RMIHash_10, RMIMonotone_10>(probe_miss_bm,dataset::ID::GAP_10);
+    dilate_probe_miss_list<RMIHash_1k, RMIMonotone_1k>(probe_miss_bm,dataset::ID::WIKI);
+    dilate_probe_miss_list<RMIHash_10M, RMIMonotone>(probe_miss_bm,dataset::ID::FB);
+
+    // ---------------- probe threads --------------- //
+    std::vector<bm::BM> probe_threads_bm = {};
+    dilate_probe_threads_list<RMIHash_1k>(probe_threads_bm,dataset::ID::WIKI);
+    dilate_probe_threads_list<RMIHash_10M>(probe_threads_bm,dataset::ID::FB);
+    dilate_probe_threads_list<RMIHash_10M>(probe_threads_bm,dataset::ID::OSM);
+    for (dataset::ID id : threads_ds) {
+        dilate_probe_threads_list<RadixSplineHash_128>(probe_threads_bm,id);
+        dilate_probe_threads_list<MURMUR>(probe_threads_bm,id);
+        dilate_probe_threads_list<MultPrime64>(probe_threads_bm,id);
+    }
+
+    // ---------------- bulk load --------------- //
+    // (monotone learned functions, where sorted keys fill the table sequentially, against a classic one)
+    std::vector<bm::BM> bulk_load_bm = {};
+    dilate_bulk_load_list<RMIMonotone_1k>(bulk_load_bm,dataset::ID::WIKI);
+    dilate_bulk_load_list<RMIMonotone>(bulk_load_bm,dataset::ID::FB);
+    for (dataset::ID id : bulk_load_ds)
+        dilate_bulk_load_list<MultPrime64>(bulk_load_bm,id);
+
+    load_bm_list(bm_list, collision_bm, gap_bm, probe_bm, probe_pareto_bm, build_bm, collisions_vs_gaps_bm, point_vs_range_bm, point_vs_range_pareto_bm, range_len_bm, range_len_pareto_bm, join_bm, probe_size_bm, join_size_bm, probe_batch_bm, tune_bm, probe_miss_bm, probe_threads_bm, bulk_load_bm);
 
     if (bm_list.size()==0) {
-        std::cerr << "Error: no benchmark functions selected.\nHint: double-check your filters! \nAvailable filters: collisions,gaps,probe[80_20],build,distribution,point[80_20],range[80_20],join,all." << std::endl;   // TODO - add more
+        std::cerr << "Error: no benchmark functions selected.\nHint: double-check your filters! \nAvailable filters: collisions,gaps,probe[80_20],build,distribution,point[80_20],range[80_20],join,probe_size,join_size,probe_batch,tune,probe_miss,probe_threads,bulk_load,all." << std::endl;   // TODO - add more
         return 1;
     }
 
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <filesystem>
 #include <vector>
 #include <algorithm>
 #include <unistd.h>
@@ -15,6 +16,7 @@
     size_t threads;
     size_t n_coro = 8;
     std::string filter = "all";
+    std::string model_cache_dir = "";
 /* ========================= */
 
 // Function to print the usage information
@@ -26,7 +28,10 @@ void show_usage() {
     std::cout << "  -c, --coro COROUTINES     Number of streams (default: 8, maximum: "<< MAX_CORO << ")" << std::endl;
     // std::cout << "  -t, --threads THREADS     Number of threads to use (default: all)" << std::endl;
     std::cout << "  -f, --filter FILTER       Type of benchmark to execute, *comma-separated* (default: all)" << std::endl;
-    std::cout << "                            Options = rmi,probe[80_20],probe_rmi,batch,all" << std::endl;    // TODO - add more
+    std::cout << "                            Options = rmi,rmi_batch,rmi_precision,probe[80_20],probe_rmi,batch,probe_size,tune,arena,all" << std::endl;    // TODO - add more
+    std::cout << "  -m, --model-cache DIR     Directory storing the trained models, reused across runs (default: none)" << std::endl;
+    std::cout << "                            Only the in-repo models (coroutine RMIs) are stored: the library ones (RMIHash_*, RadixSplineHash_*," << std::endl;
+    std::cout << "                            PGMHash_*, MWHC, RecSplit) keep their parameters private, so they are only cached in memory" << std::endl;
     std::cout << "  -h, --help                Display this help message\n" << std::endl;
 }
 int pars_args(const int& argc, char* const* const& argv) {
@@ -81,6 +86,16 @@ int pars_args(const int& argc, char* const* const& argv) {
                 return 2;
             }
         }
+        if (arg == "--model-cache" || arg == "-m") {
+            if (i + 1 < argc) {
+                model_cache_dir = argv[i + 1];
+                i++; // Skip the next argument
+                continue;
+            } else {
+                std::cerr << "Error: --model-cache requires an argument." << std::endl;
+                return 2;
+            }
+        }
         // if we are here, then the option is unknown 
         std::cerr << "Error: Unknown option " << arg << std::endl;
         show_usage();
@@ -99,6 +114,15 @@ void dilate_coro_fn(std::vector<bm::BM>& bm_out, const bm::BMcoroutine _bm_funct
     }
 }
 
+template <class HashFn>
+void dilate_coro_size_fn(std::vector<bm::BM>& bm_out, dataset::ID id, size_t sample_size) {
+    auto cp = n_coro;
+    bm::BMtype lambda = [sample_size, cp](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::probe_coroutines_size<HashFn>(ds_obj, writer, sample_size, cp);
+    };
+    bm_out.push_back({lambda,id});
+}
+
 template <class RMI>
 void dilate_rmi_fn(std::vector<bm::BMtype>& bm_out) {
     auto cp = n_coro;
@@ -108,11 +132,47 @@ void dilate_rmi_fn(std::vector<bm::BMtype>& bm_out) {
     bm_out.push_back(lambda);
 }
 
+template <class RMI>
+void dilate_rmi_batch_fn(std::vector<bm::BMtype>& bm_out) {
+    auto cp = n_coro;
+    bm::BMtype lambda = [cp](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::rmi_batch_throughput<RMI>(ds_obj, writer, cp);
+    };
+    bm_out.push_back(lambda);
+}
+
+template <class RMI, class ReferenceRMI>
+void dilate_rmi_precision_fn(std::vector<bm::BM>& bm_out, dataset::ID id) {
+    auto cp = n_coro;
+    bm::BMtype lambda = [cp](const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
+        bm::rmi_precision<RMI, ReferenceRMI>(ds_obj, writer, cp);
+    };
+    bm_out.push_back({lambda,id});
+}
+
+// whether the filter selects the benchmark type `part` (also through "all")
+bool filter_selects(const std::string& part) {
+    size_t start;
+    size_t end = 0;
+    while ((start = filter.find_first_not_of(',', end)) != std::string::npos) {
+        end = filter.find(',', start);
+        const std::string selected = filter.substr(start, end-start);
+        if (selected == part || selected == "all")
+            return true;
+    }
+    return false;
+}
+
 void load_bm_list(std::vector<bm::BM>& bm_list,
         const std::vector<bm::BM>& probe_bm, const std::vector<bm::BM>& probe_pareto_bm,
         const std::vector<bm::BM>& probe_rmi_bm,
         const std::vector<bm::BMtype>& rmi_bm,
-        const std::vector<bm::BM>& batch_bm
+        const std::vector<bm::BM>& batch_bm,
+        const std::vector<bm::BM>& probe_size_bm,
+        const std::vector<bm::BMtype>& rmi_batch_bm,
+        const std::vector<bm::BM>& rmi_precision_bm,
+        const std::vector<bm::BM>& tune_bm,
+        const std::vector<bm::BM>& arena_bm
         /*TODO - add more*/) {
     std::string part;
     size_t start;
@@ -138,6 +198,12 @@ void load_bm_list(std::vector<bm::BM>& bm_list,
             }
             if (part != "all") continue;
         }
+        if (part == "probe_size" || part == "all") {
+            for (const bm::BM& bm_struct : probe_size_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
         if (part == "rmi" || part == "all") {
             for (const bm::BMtype& bm_fn : rmi_bm) {
                 for (dataset::ID id : collisions_ds)
@@ -145,6 +211,31 @@ void load_bm_list(std::vector<bm::BM>& bm_list,
             }
             if (part != "all") continue;
         }
+        if (part == "rmi_batch" || part == "all") {
+            for (const bm::BMtype& bm_fn : rmi_batch_bm) {
+                for (dataset::ID id : collisions_ds)
+                    bm_list.push_back({bm_fn, id});
+            }
+            if (part != "all") continue;
+        }
+        if (part == "rmi_precision" || part == "all") {
+            for (const bm::BM& bm_struct : rmi_precision_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
+        if (part == "tune" || part == "all") {
+            for (const bm::BM& bm_struct : tune_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
+        if (part == "arena" || part == "all") {
+            for (const bm::BM& bm_struct : arena_bm) {
+                bm_list.push_back(bm_struct);
+            }
+            if (part != "all") continue;
+        }
         if (part == "probe_rmi" || part == "all") {
             for (const bm::BM& bm_struct : probe_rmi_bm) {
                 bm_list.push_back(bm_struct);
@@ -178,6 +269,10 @@ int main(int argc, char* argv[]) {
 
     // Create a JsonWriter instance (for the output file)
     JsonOutput writer(output_dir, argv[0], "coroutines-"+filter);
+    if (model_cache_dir != "") {
+        std::filesystem::create_directories(model_cache_dir);
+        model_cache::Cache::instance().set_directory(model_cache_dir);
+    }
 
     // Benchmark arrays definition
     std::vector<bm::BM> bm_list;
@@ -193,6 +288,30 @@ int main(int argc, char* argv[]) {
     dilate_rmi_fn<RMICoro_1M>(rmi_bm);
     dilate_rmi_fn<RMICoro_10M>(rmi_bm);
     dilate_rmi_fn<RMICoro_100M>(rmi_bm);
+    // huge pages
+    dilate_rmi_fn<RMICoroTHP_10M>(rmi_bm);
+    dilate_rmi_fn<RMICoroTHP_100M>(rmi_bm);
+    dilate_rmi_fn<RMICoroHugeTLB_10M>(rmi_bm);
+    dilate_rmi_fn<RMICoroHugeTLB_100M>(rmi_bm);
+    // spline (with and without radix table), prefetching each level of the search
+    dilate_rmi_fn<RadixSplineCoro_16>(rmi_bm);
+    dilate_rmi_fn<RadixSplineCoro_128>(rmi_bm);
+    dilate_rmi_fn<RadixSplineCoro_1k>(rmi_bm);
+    dilate_rmi_fn<SplineCoro_16>(rmi_bm);
+    dilate_rmi_fn<SplineCoro_128>(rmi_bm);
+    dilate_rmi_fn<SplineCoro_1k>(rmi_bm);
+
+    // rmi batch
+    std::vector<bm::BMtype> rmi_batch_bm = {};
+    dilate_rmi_batch_fn<RMICoro_2>(rmi_batch_bm);
+    dilate_rmi_batch_fn<RMICoro_10>(rmi_batch_bm);
+    dilate_rmi_batch_fn<RMICoro_100>(rmi_batch_bm);
+    dilate_rmi_batch_fn<RMICoro_1k>(rmi_batch_bm);
+    dilate_rmi_batch_fn<RMICoro_10k>(rmi_batch_bm);
+    dilate_rmi_batch_fn<RMICoro_100k>(rmi_batch_bm);
+    dilate_rmi_batch_fn<RMICoro_1M>(rmi_batch_bm);
+    dilate_rmi_batch_fn<RMICoro_10M>(rmi_batch_bm);
+    dilate_rmi_batch_fn<RMICoro_100M>(rmi_batch_bm);
 
     // ---------------- probe --------------- //
     std::vector<bm::BM> probe_bm = {};
@@ -249,11 +368,95 @@ int main(int argc, char* argv[]) {
     dilate_coro_fn(probe_rmi_bm,&bm::probe_coroutines<RMICoro_1k, RMIChainedTableCoro<RMICoro_1k>>,dataset::ID::WIKI);
     dilate_coro_fn(probe_rmi_bm,&bm::probe_coroutines<RMICoro_10M, RMIChainedTableCoro<RMICoro_10M>>,dataset::ID::FB);
     dilate_coro_fn(probe_rmi_bm,&bm::probe_coroutines<RMICoro_10M, RMIChainedTableCoro<RMICoro_10M>>,dataset::ID::OSM);
+    // huge pages (both for the models and the table slots)
+    for (dataset::ID id : {dataset::ID::FB, dataset::ID::OSM}) {
+        dilate_coro_fn(probe_rmi_bm,&bm::probe_coroutines<RMICoroTHP_10M, RMIChainedTableCoroHuge<RMICoroTHP_10M>>,id);
+        dilate_coro_fn(probe_rmi_bm,&bm::probe_coroutines<RMICoroHugeTLB_10M, RMIChainedTableCoroHuge<RMICoroHugeTLB_10M>>,id);
+    }
+    // spline (with and without radix table), same error as the RadixSpline and PGM of the probe experiment
+    for (dataset::ID id : probe_insert_ds) {
+        dilate_coro_fn(probe_rmi_bm,&bm::probe_coroutines<RadixSplineCoro_128, RMIChainedTableCoro<RadixSplineCoro_128>>,id);
+        dilate_coro_fn(probe_rmi_bm,&bm::probe_coroutines<SplineCoro_128, RMIChainedTableCoro<SplineCoro_128>>,id);
+    }
+
+    // ---------------- probe size sweep --------------- //
+    std::vector<bm::BM> probe_size_bm = {};
+    for (dataset::ID id : sweep_ds) {
+        for (size_t s : sweep_sizes) {
+            // RMI, keeping around 100 keys per second level model
+            if (s <= k(3))
+                dilate_coro_size_fn<RMIHash_10>(probe_size_bm,id,s);
+            else if (s <= k(30))
+                dilate_coro_size_fn<RMIHash_100>(probe_size_bm,id,s);
+            else if (s <= k(300))
+                dilate_coro_size_fn<RMIHash_1k>(probe_size_bm,id,s);
+            else if (s <= M(3))
+                dilate_coro_size_fn<RMIHash_10k>(probe_size_bm,id,s);
+            else if (s <= M(30))
+                dilate_coro_size_fn<RMIHash_100k>(probe_size_bm,id,s);
+            else dilate_coro_size_fn<RMIHash_1M>(probe_size_bm,id,s);
+            dilate_coro_size_fn<RadixSplineHash_128>(probe_size_bm,id,s);
+            dilate_coro_size_fn<PGMHash_100>(probe_size_bm,id,s);
+            dilate_coro_size_fn<MURMUR>(probe_size_bm,id,s);
+            dilate_coro_size_fn<MultPrime64>(probe_size_bm,id,s);
+            dilate_coro_size_fn<MWHC>(probe_size_bm,id,s);
+        }
+    }
+
+    // ---------------- RMI precision --------------- //
+    std::vector<bm::BM> rmi_precision_bm = {};
+    for (dataset::ID id : collisions_ds) {
+        dilate_rmi_precision_fn<RMICoro_10k, RMICoro_10k>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoroFloat_10k, RMICoro_10k>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoroFixed_10k, RMICoro_10k>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoro_1M, RMICoro_1M>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoroFloat_1M, RMICoro_1M>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoroFixed_1M, RMICoro_1M>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoro_10M, RMICoro_10M>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoroFloat_10M, RMICoro_10M>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoroFixed_10M, RMICoro_10M>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoro_100M, RMICoro_100M>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoroFloat_100M, RMICoro_100M>(rmi_precision_bm,id);
+        dilate_rmi_precision_fn<RMICoroFixed_100M, RMICoro_100M>(rmi_precision_bm,id);
+    }
+    // the hard datasets, where large models pay off
+    for (dataset::ID id : {dataset::ID::WIKI, dataset::ID::FB, dataset::ID::OSM}) {
+        dilate_coro_fn(rmi_precision_bm,&bm::probe_coroutines<RMICoro_10M, RMIChainedTableCoro<RMICoro_10M>>,id);
+        dilate_coro_fn(rmi_precision_bm,&bm::probe_coroutines<RMICoroFloat_10M, RMIChainedTableCoro<RMICoroFloat_10M>>,id);
+        dilate_coro_fn(rmi_precision_bm,&bm::probe_coroutines<RMICoroFixed_10M, RMIChainedTableCoro<RMICoroFixed_10M>>,id);
+        dilate_coro_fn(rmi_precision_bm,&bm::probe_coroutines<RMICoro_100M, RMIChainedTableCoro<RMICoro_100M>>,id);
+        dilate_coro_fn(rmi_precision_bm,&bm::probe_coroutines<RMICoroFloat_100M, RMIChainedTableCoro<RMICoroFloat_100M>>,id);
+        dilate_coro_fn(rmi_precision_bm,&bm::probe_coroutines<RMICoroFixed_100M, RMIChainedTableCoro<RMICoroFixed_100M>>,id);
+    }
+
+    // ---------------- tuned functions --------------- //
+    std::vector<bm::BM> tune_bm = {};
+    for (dataset::ID id : probe_insert_ds)
+        dilate_coro_fn(tune_bm,&bm::tuned_probe_coroutines<RMITuningCandidates>,id);
+
+    // ---------------- overflow bucket arena --------------- //
+    // (the heap bucket baselines already run in the probe and probe_rmi lists are not registered twice)
+    const bool with_probe = filter_selects("probe"), with_probe_rmi = filter_selects("probe_rmi");
+    std::vector<bm::BM> arena_bm = {};
+    for (dataset::ID id : probe_insert_ds) {
+        if (!with_probe)
+            dilate_coro_fn(arena_bm,&bm::probe_coroutines<MURMUR, ChainedTableCoro<MURMUR>>,id);
+        dilate_coro_fn(arena_bm,&bm::probe_coroutines<MURMUR, ChainedTableCoroArena<MURMUR>>,id);
+        if (!with_probe_rmi || id != dataset::ID::NORMAL)
+            dilate_coro_fn(arena_bm,&bm::probe_coroutines<RMICoro_100, RMIChainedTableCoro<RMICoro_100>>,id);
+        dilate_coro_fn(arena_bm,&bm::probe_coroutines<RMICoro_100, RMIChainedTableCoroArena<RMICoro_100>>,id);
+    }
+    // huge pages (the models, the table slots and the bucket chunks)
+    for (dataset::ID id : {dataset::ID::FB, dataset::ID::OSM}) {
+        if (!with_probe_rmi)
+            dilate_coro_fn(arena_bm,&bm::probe_coroutines<RMICoroTHP_10M, RMIChainedTableCoroHuge<RMICoroTHP_10M>>,id);
+        dilate_coro_fn(arena_bm,&bm::probe_coroutines<RMICoroTHP_10M, RMIChainedTableCoroHugeArena<RMICoroTHP_10M>>,id);
+    }
 
-    load_bm_list(bm_list, probe_bm, probe_pareto_bm, probe_rmi_bm, rmi_bm, batch_bm);
+    load_bm_list(bm_list, probe_bm, probe_pareto_bm, probe_rmi_bm, rmi_bm, batch_bm, probe_size_bm, rmi_batch_bm, rmi_precision_bm, tune_bm, arena_bm);
 
     if (bm_list.size()==0) {
-        std::cerr << "Error: no benchmark functions selected.\nHint: double-check your filters! \nAvailable filters: rmi,probe[80_20],probe_rmi,batch,all." << std::endl;   // TODO - add more
+        std::cerr << "Error: no benchmark functions selected.\nHint: double-check your filters! \nAvailable filters: rmi,rmi_batch,rmi_precision,probe[80_20],probe_rmi,batch,probe_size,tune,arena,all." << std::endl;   // TODO - add more
         return 1;
     }
 
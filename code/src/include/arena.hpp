@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "huge_pages.hpp"
+
+// arena.hpp - a bump allocator for the overflow buckets of the chained tables.
+// Buckets are carved out of HUGE_PAGE sized chunks (optionally mapped on huge pages), so that consecutive allocations
+// are adjacent in memory, and they are never freed one by one: release() drops all the chunks at once.
+
+namespace mem {
+
+    template <class T, Pages P = Pages::NONE>
+    class Arena {
+        public:
+            static constexpr size_t CHUNK_BYTES = HUGE_PAGE;
+            static constexpr size_t PER_CHUNK = CHUNK_BYTES / sizeof(T);
+            static_assert(PER_CHUNK > 0 && alignof(T) <= CACHE_LINE);
+
+            Arena() = default;
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+            Arena(Arena&& other) noexcept : chunks(std::move(other.chunks)), used(other.used) {
+                other.chunks.clear();
+                other.used = PER_CHUNK;
+            }
+            Arena& operator=(Arena&& other) noexcept {
+                if (this != &other) {
+                    release();
+                    chunks = std::move(other.chunks);
+                    used = other.used;
+                    other.chunks.clear();
+                    other.used = PER_CHUNK;
+                }
+                return *this;
+            }
+            ~Arena() {
+                release();
+            }
+
+            /**
+             * Constructs a T in the current chunk (in a new one, if it is full).
+             * @param args the arguments of the constructor of T
+             * @return a pointer that stays valid until release()
+            */
+            template <class... Args>
+            T* make(Args&&... args) {
+                if (used == PER_CHUNK) {
+                    chunks.push_back(allocator.allocate(CHUNK_BYTES));
+                    used = 0;
+                }
+                return new (chunks.back() + (used++) * sizeof(T)) T(std::forward<Args>(args)...);
+            }
+
+            /**
+             * Destroys all the objects and frees all the chunks.
+            */
+            void release() noexcept {
+                for (size_t c = 0; c < chunks.size(); c++) {
+                    if constexpr (!std::is_trivially_destructible_v<T>) {
+                        const size_t count = (c + 1 == chunks.size()) ? used : PER_CHUNK;
+                        for (size_t i = 0; i < count; i++)
+                            std::launder(reinterpret_cast<T*>(chunks[c] + i * sizeof(T)))->~T();
+                    }
+                    allocator.deallocate(chunks[c], CHUNK_BYTES);
+                }
+                chunks.clear();
+                used = PER_CHUNK;
+            }
+
+            // objects allocated so far
+            size_t size() const {
+                return chunks.empty() ? 0 : (chunks.size() - 1) * PER_CHUNK + used;
+            }
+            // memory reserved by the chunks
+            size_t byte_size() const {
+                return chunks.size() * CHUNK_BYTES;
+            }
+
+        private:
+            [[no_unique_address]] HugePageAllocator<std::byte, P> allocator;
+            std::vector<std::byte*> chunks;
+            size_t used = PER_CHUNK;    // objects in the last chunk
+    };
+
+}   // namespace mem
@@ -5,9 +5,14 @@
 #include <cstdint>
 #include <random>
 #include <cmath>
+#include <numeric>
+#include <linux/perf_event.h>
 
 #include "generic_function.hpp"
+#include "model_cache.hpp"
+#include "tuner.hpp"
 #include "npj.hpp"
+#include "bulk_load.hpp"
 #include "output_json.hpp"
 #include "datasets.hpp"
 #include "configs.hpp"
@@ -101,6 +106,27 @@ namespace bm {
         }
     }
 
+    /**
+     * Generates local insert and probe orders for a (sampled) dataset of size n, used by the size sweep experiments.
+     * The probe order is uniform, and it has at least SWEEP_MIN_PROBES elements.
+     * @param n the size of the dataset
+     * @param insert_order the output insert order (all values from 0 to n-1)
+     * @param probe_order the output probe order (uniformly sampled values from 0 to n-1)
+    */
+    void make_sweep_orders(size_t n, std::vector<int>& insert_order, std::vector<int>& probe_order) {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        insert_order.resize(n);
+        std::iota(insert_order.begin(), insert_order.end(), 0);
+        std::shuffle(insert_order.begin(), insert_order.end(), gen);
+        const size_t probes = std::max<size_t>(n, SWEEP_MIN_PROBES);
+        std::uniform_int_distribution<int> distribution(0, n-1);
+        probe_order.clear();
+        probe_order.reserve(probes);
+        for (size_t i = 0; i < probes; ++i)
+            probe_order.push_back(distribution(gen));
+    }
+
     /**
      * Init all global variable to support benchmarks
      * @param the number of threads that will be used in the parallel build & probe
@@ -140,9 +166,27 @@ namespace bm {
         // done!
     }
 
+    // adds the statistics that only some functions have (e.g. the segments of a hybrid function)
+    template <class HashFn>
+    void function_stats(json& benchmark, const HashFn& fn) {
+        if constexpr (requires { fn.fallback_segments(); }) {
+            benchmark["learned_segments"] = fn.learned_segments();
+            benchmark["fallback_segments"] = fn.fallback_segments();
+            benchmark["avg_fit_error"] = fn.avg_fit_error();
+        }
+    }
+
+    // the reduction of a function in the labels (FastModulo, the default one, is omitted)
+    template <class ReductionFn>
+    std::string reduction_suffix() {
+        if constexpr (std::is_same_v<ReductionFn, FastModulo>)
+            return "";
+        else return "_" + ReductionFn::name();
+    }
+
     // ----------------- benchmarks list ----------------- //
     // collision+distribution
-    template <class HashFn>
+    template <class HashFn, class ReductionFn = FastModulo>
     void collisions_vs_gaps(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc) {
         // Extract variables
         const size_t dataset_size = ds_obj.get_size();
@@ -154,9 +198,10 @@ namespace bm {
         if (load_perc==0)
             capacity=dataset_size;
         else capacity = dataset_size*100/load_perc;
+        capacity = reduction::table_size<ReductionFn>(capacity);
 
-        _generic_::GenericFn<HashFn> fn(ds.begin(), ds.end(), capacity);
-        const std::string label = "Collisions:" + fn.name() + ":" + dataset_name + ":" + std::to_string(load_perc);
+        _generic_::GenericFn<HashFn, ReductionFn> fn(ds.begin(), ds.end(), capacity);
+        const std::string label = "Collisions:" + fn.name() + reduction_suffix<ReductionFn>() + ":" + dataset_name + ":" + std::to_string(load_perc);
 
         // now, start counting collisions
 
@@ -167,7 +212,7 @@ namespace bm {
         // ====================== collision counters ====================== //
         Key index;
         /*volatile*/ std::chrono::high_resolution_clock::time_point _start_, _end_, start_for, end_for;
-        /*volatile*/ std::chrono::duration<double> tot_time(0), tot_for(0);
+        /*volatile*/ std::chrono::duration<double> tot_time(0), tot_for(0), tot_batch(0);
         size_t collisions_count = 0;
         size_t NOT_collisions_count = 0;
         // ================================================================ //
@@ -187,6 +232,24 @@ namespace bm {
         end_for = std::chrono::high_resolution_clock::now();
         tot_for = end_for - start_for;
 
+        // now, hash the same entries in a single batch
+        std::vector<Data> batch_in;
+        std::vector<Key> batch_out(dataset_size);
+        batch_in.reserve(dataset_size);
+        for (int i : order_insert) {
+            if (i < (int)dataset_size)
+                batch_in.push_back(ds[i]);
+        }
+        _start_ = std::chrono::high_resolution_clock::now();
+        fn.hash_batch(batch_in.data(), batch_out.data(), batch_in.size());
+        _end_ = std::chrono::high_resolution_clock::now();
+        tot_batch = _end_ - _start_;
+        for (size_t i = 0; i < batch_in.size(); i++) {
+            if (batch_out[i] != fn(batch_in[i])) {
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m batch_out[i]==fn(batch_in[i])\n           In --> " + label + "\n           [batch_out[i]] " + std::to_string(batch_out[i]) + "\n           [fn(batch_in[i])] " + std::to_string(fn(batch_in[i])) + "\n");
+            }
+        }
+
         // count collisions
         for (auto k : keys_count) {
             if (k > 1)
@@ -203,18 +266,23 @@ namespace bm {
         benchmark["dataset_size"] = dataset_size;
         benchmark["tot_time_s"] = tot_time.count();
         benchmark["tot_for_time_s"] = tot_for.count();
+        benchmark["tot_batch_time_s"] = tot_batch.count();
+        benchmark["batch_vectorized"] = fn.is_batch_vectorized();
         benchmark["collisions"] = collisions_count;
         benchmark["dataset_name"] = dataset_name;
         benchmark["load_factor_%"] = load_perc;
+        benchmark["capacity"] = capacity;
+        benchmark["reduction"] = ReductionFn::name();
         benchmark["label"] = label; 
+        function_stats(benchmark, fn.function());
         std::cout << label + "\n";
         writer.add_data(benchmark);
     }
     
     // collision wrapper
-    template <class HashFn>
+    template <class HashFn, class ReductionFn = FastModulo>
     inline void collision_stats(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer) {
-        collisions_vs_gaps<HashFn>(ds_obj, writer, 0);
+        collisions_vs_gaps<HashFn, ReductionFn>(ds_obj, writer, 0);
     }
 
     // gaps
@@ -231,15 +299,8 @@ namespace bm {
         // now, start counting collisions
 
         // stores the list of hash values (keys)
-        std::vector<Key> keys;
-        keys.reserve(dataset_size);
-
-        size_t index;
-
-        for (auto data : ds) {
-            index = fn(data);
-            keys.push_back(index);
-        }
+        std::vector<Key> keys(dataset_size);
+        fn.hash_batch(ds.data(), keys.data(), dataset_size);
 
         // now, sort keys
         std::sort(keys.begin(), keys.end());
@@ -274,40 +335,28 @@ namespace bm {
         writer.add_data(benchmark);
     }
 
-    // probe throughput helper
-    template <class HashFn, class HashTable>
-    void probe_throughput(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc, ProbeType probe_type, 
+    // probe throughput helper (ReductionFn is the one of HashTable, it sets the table size)
+    // With Mode == BULK_LOAD, the keys of insert_order are sorted (not timed, see tot_time_sort_s) and loaded with bulk::load
+    template <class HashFn, class HashTable, class ReductionFn = FastModulo, bulk::BuildMode Mode = bulk::BuildMode::INSERT>
+    void probe_helper(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc,
+            const std::vector<int>& insert_order, const std::vector<int>& probe_order, const std::string& probe_label, const std::string& label,
             /* perf stuff */ std::string perf_config = "", std::ostream& perf_out = std::cout) {
         // Extract variables
         const size_t dataset_size = ds_obj.get_size();
         const std::string dataset_name = dataset::name(ds_obj.get_id());
         const std::vector<Data>& ds = ds_obj.get_ds();
 
-        // Choose probe distribution
-        std::vector<int>* order_probe = nullptr;
-        std::string probe_label;
-        switch(probe_type) {
-            case ProbeType::UNIFORM:
-                order_probe = &order_probe_uniform;
-                probe_label = "uniform";
-                break;
-            case ProbeType::PARETO_80_20:
-                order_probe = &order_probe_80_20;
-                probe_label = "80-20";
-        }
-
         // Compute capacity given the laod% and the dataset_size
-        size_t capacity = dataset_size*100/load_perc;
+        const size_t capacity = reduction::table_size<ReductionFn>(dataset_size*100/load_perc);
         
         // now, create the table
-        HashFn fn;
-        _generic_::GenericFn<HashFn>::init_fn(fn,ds.begin(),ds.end(),capacity);
+        const auto model = model_cache::get<HashFn>(ds.begin(), ds.end(), capacity);
+        const HashFn& fn = *model.fn;
         HashTable table(capacity, fn);
-        const std::string label = "Probe:" + table.name() + ":" + dataset_name + ":" + std::to_string(load_perc) + ":" + probe_label;
 
         // ====================== throughput counters ====================== //
         /*volatile*/ std::chrono::high_resolution_clock::time_point _start_, _end_, start_for, end_for;
-        /*volatile*/ std::chrono::duration<double> tot_time_insert(0), tot_time_probe(0), tot_for_insert(0), tot_for_probe(0);
+        /*volatile*/ std::chrono::duration<double> tot_time_insert(0), tot_time_probe(0), tot_for_insert(0), tot_for_probe(0), tot_time_sort(0);
         size_t insert_count = 0;
         size_t probe_count = 0;
         std::string fail_what = "";
@@ -317,34 +366,60 @@ namespace bm {
 
         // Build the table
         Payload count = 0;
-        start_for = std::chrono::high_resolution_clock::now();
-        for (int i : order_insert) {
-            // check if the index exists
-            if (i < (int)dataset_size) {
-                // get the data
-                Data data = ds[i];
-                try {
-                    _start_ = std::chrono::high_resolution_clock::now();
-                    table.insert(data, count);
-                    _end_ = std::chrono::high_resolution_clock::now();
-                } catch(std::runtime_error& e) {
-                    // if we are here, we failed the insertion
-                    insert_fail = true;
-                    fail_what = e.what();
-                    goto done;
+        if constexpr (Mode == bulk::BuildMode::BULK_LOAD) {
+            std::vector<Data> keys;
+            std::vector<Payload> payloads;
+            for (int i : insert_order) {
+                if (i < (int)dataset_size) {
+                    keys.push_back(ds[i]);
+                    payloads.push_back(count++);
+                }
+            }
+            _start_ = std::chrono::high_resolution_clock::now();
+            sort_indices(keys, payloads);
+            _end_ = std::chrono::high_resolution_clock::now();
+            tot_time_sort = _end_ - _start_;
+            try {
+                start_for = std::chrono::high_resolution_clock::now();
+                bulk::load(table, keys, payloads);
+                end_for = std::chrono::high_resolution_clock::now();
+            } catch(std::runtime_error& e) {
+                insert_fail = true;
+                fail_what = e.what();
+                goto done;
+            }
+            insert_count = keys.size();
+            tot_time_insert = tot_for_insert = end_for - start_for;
+        } else {
+            start_for = std::chrono::high_resolution_clock::now();
+            for (int i : insert_order) {
+                // check if the index exists
+                if (i < (int)dataset_size) {
+                    // get the data
+                    Data data = ds[i];
+                    try {
+                        _start_ = std::chrono::high_resolution_clock::now();
+                        table.insert(data, count);
+                        _end_ = std::chrono::high_resolution_clock::now();
+                    } catch(std::runtime_error& e) {
+                        // if we are here, we failed the insertion
+                        insert_fail = true;
+                        fail_what = e.what();
+                        goto done;
+                    }
+                    count++;
+                    insert_count++;
+                    tot_time_insert += _end_ - _start_;
                 }
-                count++;
-                insert_count++;
-                tot_time_insert += _end_ - _start_;
             }
+            end_for = std::chrono::high_resolution_clock::now();
+            tot_for_insert = end_for - start_for;
         }
-        end_for = std::chrono::high_resolution_clock::now();
-        tot_for_insert = end_for - start_for;
 
         if (is_perf)
             e.startCounters();
         start_for = std::chrono::high_resolution_clock::now();
-        for (int i : *order_probe) {
+        for (int i : probe_order) {
             // check if the index exists
             if (i < (int)dataset_size) {
                 // get the data
@@ -366,6 +441,8 @@ namespace bm {
 
     done:
         json benchmark;
+        benchmark["model_build_time_s"] = model.build_time_s;
+        benchmark["model_cached"] = model.cached;
         benchmark["dataset_size"] = dataset_size;
         benchmark["probe_elem_count"] = probe_count;
         benchmark["insert_elem_count"] = insert_count;
@@ -373,12 +450,28 @@ namespace bm {
         benchmark["tot_time_insert_s"] = tot_time_insert.count();
         benchmark["tot_for_time_probe_s"] = tot_for_probe.count();
         benchmark["tot_for_time_insert_s"] = tot_for_insert.count();
+        benchmark["tot_time_sort_s"] = tot_time_sort.count();
+        benchmark["build_mode"] = bulk::name<HashTable,Data,Payload>(Mode);
         benchmark["load_factor_%"] = load_perc;
+        benchmark["capacity"] = capacity;
+        benchmark["reduction"] = ReductionFn::name();
         benchmark["dataset_name"] = dataset_name;
         benchmark["function_name"] = HashFn::name();
         benchmark["insert_fail_message"] = fail_what;
         benchmark["label"] = label;
         benchmark["probe_type"] = probe_label;
+        if constexpr (requires { table.byte_size(); }) {
+            benchmark["table_bytes"] = table.byte_size();
+            benchmark["bytes_per_key"] = insert_count ? double(table.byte_size()) / insert_count : 0.0;
+        }
+        if constexpr (requires { table.stash_count(); })
+            benchmark["stash_count"] = table.stash_count();
+        if constexpr (requires { table.displacement_histogram(); }) {
+            benchmark["mean_displacement"] = table.mean_displacement();
+            benchmark["max_displacement"] = table.max_displacement();
+            benchmark["displacement_histogram"] = table.displacement_histogram();
+        }
+        function_stats(benchmark, fn);
 
         if (insert_fail)
             std::cout << "\033[1;91mInsert failed >\033[0m " + label + "\n";
@@ -391,6 +484,302 @@ namespace bm {
         }
     }
 
+    // probe throughput (Mode is how the table is built, see probe_helper)
+    template <class HashFn, class HashTable, class ReductionFn = FastModulo, bulk::BuildMode Mode = bulk::BuildMode::INSERT>
+    void probe_throughput(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc, ProbeType probe_type, 
+            /* perf stuff */ std::string perf_config = "", std::ostream& perf_out = std::cout) {
+        // Choose probe distribution
+        std::vector<int>* order_probe = nullptr;
+        std::string probe_label;
+        switch(probe_type) {
+            case ProbeType::UNIFORM:
+                order_probe = &order_probe_uniform;
+                probe_label = "uniform";
+                break;
+            case ProbeType::PARETO_80_20:
+                order_probe = &order_probe_80_20;
+                probe_label = "80-20";
+        }
+        std::string label = "Probe:" + HashTable::name() + ":" + dataset::name(ds_obj.get_id()) + ":" + std::to_string(load_perc) + ":" + probe_label;
+        if (Mode != bulk::BuildMode::INSERT)
+            label += ":" + bulk::name<HashTable,Data,Payload>(Mode);
+        probe_helper<HashFn,HashTable,ReductionFn,Mode>(ds_obj, writer, load_perc, order_insert, *order_probe, probe_label, label, perf_config, perf_out);
+    }
+
+    // probe throughput, on a random sample of the dataset
+    template <class HashFn, class HashTable>
+    void probe_size(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t sample_size, size_t load_perc) {
+        dataset::Dataset<Data> sample(ds_obj, sample_size);
+        std::vector<int> insert_order, probe_order;
+        make_sweep_orders(sample.get_size(), insert_order, probe_order);
+        const std::string label = "Probe-size:" + HashTable::name() + ":" + dataset::name(ds_obj.get_id()) + ":" + std::to_string(sample.get_size()) + ":" + std::to_string(load_perc);
+        probe_helper<HashFn,HashTable>(sample, writer, load_perc, insert_order, probe_order, "uniform", label);
+    }
+
+    /**
+     * Insert and probe throughput of a concurrent table, built and probed by 1, 2, 4, ... threads
+     * (up to the OpenMP default), in the same order as the probe experiment. A table with batched operations
+     * (insert_batch, lookup_batch) gets all the keys at once, and runs them with its own threads.
+     * @param load_perc the load factor of the table
+    */
+    template <class HashFn, class HashTable, class ReductionFn = FastModulo>
+    void probe_threads(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc) {
+        // Extract variables
+        const size_t dataset_size = ds_obj.get_size();
+        const std::string dataset_name = dataset::name(ds_obj.get_id());
+        const std::vector<Data>& ds = ds_obj.get_ds();
+        const std::string label = "Probe-threads:" + HashTable::name() + ":" + dataset_name + ":" + std::to_string(load_perc);
+
+        // Compute capacity given the laod% and the dataset_size
+        const size_t capacity = reduction::table_size<ReductionFn>(dataset_size*100/load_perc);
+        const auto model = model_cache::get<HashFn>(ds.begin(), ds.end(), capacity);
+        const HashFn& fn = *model.fn;
+
+        // the keys to insert (the payload is the position in the dataset) and to probe, in order
+        std::vector<Key> insert_keys, probe_keys;
+        std::vector<Payload> insert_payloads;
+        for (int idx : order_insert) {
+            if (idx < (int)dataset_size) {
+                insert_keys.push_back(ds[idx]);
+                insert_payloads.push_back(idx);
+            }
+        }
+        for (int idx : order_probe_uniform) {
+            if (idx < (int)dataset_size)
+                probe_keys.push_back(ds[idx]);
+        }
+        const size_t probe_count = probe_keys.size();
+
+        json scaling = json::array();
+        const size_t max_threads = omp_get_max_threads();
+        for (size_t threads = 1; ; threads = std::min(2 * threads, max_threads)) {
+            HashTable table(capacity, fn, threads);
+            size_t insert_count = 0, not_found = 0;
+            std::string fail_what = "";
+
+            // Build the table
+            auto _start_ = std::chrono::high_resolution_clock::now();
+            if constexpr (requires { table.insert_batch(insert_keys, insert_payloads); }) {
+                try {
+                    insert_count = table.insert_batch(insert_keys, insert_payloads);
+                } catch(std::runtime_error& e) {
+                    fail_what = e.what();
+                }
+            } else {
+                #pragma omp parallel for num_threads(threads) schedule(static) reduction(+:insert_count)
+                for (size_t i = 0; i < insert_keys.size(); i++) {
+                    // (an exception cannot leave the parallel region)
+                    try {
+                        insert_count += table.insert(insert_keys[i], insert_payloads[i]);
+                    } catch(std::runtime_error& e) {
+                        #pragma omp critical
+                        fail_what = e.what();
+                    }
+                }
+            }
+            auto _end_ = std::chrono::high_resolution_clock::now();
+            const double insert_time = std::chrono::duration<double>(_end_ - _start_).count();
+            if (!fail_what.empty()) {
+                std::cout << "\033[1;91mInsert failed >\033[0m " + label + " (" + std::to_string(threads) + " threads)\n";
+                json point;
+                point["threads"] = threads;
+                point["insert_elem_count"] = insert_count;
+                point["insert_fail_message"] = fail_what;
+                scaling.push_back(point);
+                break;
+            }
+
+            double probe_time;
+            if constexpr (requires (std::vector<std::optional<Payload>>& out) { table.lookup_batch(probe_keys, out); }) {
+                std::vector<std::optional<Payload>> out(probe_count);     // (allocated out of the timed region)
+                _start_ = std::chrono::high_resolution_clock::now();
+                table.lookup_batch(probe_keys, out);
+                _end_ = std::chrono::high_resolution_clock::now();
+                probe_time = std::chrono::duration<double>(_end_ - _start_).count();
+                not_found = std::count_if(out.begin(), out.end(), [](const std::optional<Payload>& p) { return !p.has_value(); });
+            } else {
+                _start_ = std::chrono::high_resolution_clock::now();
+                #pragma omp parallel for num_threads(threads) schedule(static) reduction(+:not_found)
+                for (size_t i = 0; i < probe_count; i++)
+                    not_found += !table.lookup(probe_keys[i]).has_value();
+                _end_ = std::chrono::high_resolution_clock::now();
+                probe_time = std::chrono::duration<double>(_end_ - _start_).count();
+            }
+            if (not_found > 0)
+                throw std::runtime_error("\033[1;91mError\033[0m Data not found...\n           [not found] " + std::to_string(not_found) + "\n           [label] " + label + "\n");
+
+            json point;
+            point["threads"] = threads;
+            point["insert_elem_count"] = insert_count;
+            point["probe_elem_count"] = probe_count;
+            point["tot_time_insert_s"] = insert_time;
+            point["tot_time_probe_s"] = probe_time;
+            point["insert_mops"] = insert_time > 0 ? insert_count / insert_time / 1e6 : 0.0;
+            point["probe_mops"] = probe_time > 0 ? probe_count / probe_time / 1e6 : 0.0;
+            if constexpr (requires { table.cas_retries(); })
+                point["cas_retries"] = table.cas_retries();
+            if constexpr (requires { table.shard_sizes(); }) {
+                const std::vector<size_t> sizes = table.shard_sizes();
+                point["shard_sizes"] = sizes;
+                // the largest shard over the average one (the slowest thread)
+                point["shard_imbalance"] = insert_count ? double(*std::max_element(sizes.begin(), sizes.end())) * sizes.size() / insert_count : 0.0;
+            }
+            if constexpr (requires { table.probe_length(Key()); }) {
+                double length = 0;
+                #pragma omp parallel for num_threads(threads) schedule(static) reduction(+:length)
+                for (size_t i = 0; i < dataset_size; i++)
+                    length += table.probe_length(ds[i]);
+                point["mean_probe_length"] = dataset_size ? length / dataset_size : 0.0;
+            }
+            if constexpr (requires { table.byte_size(); })
+                point["table_bytes"] = table.byte_size();
+            scaling.push_back(point);
+            if (threads == max_threads)
+                break;
+        }
+
+        json benchmark;
+        benchmark["model_build_time_s"] = model.build_time_s;
+        benchmark["model_cached"] = model.cached;
+        benchmark["dataset_size"] = dataset_size;
+        benchmark["load_factor_%"] = load_perc;
+        benchmark["capacity"] = capacity;
+        benchmark["reduction"] = ReductionFn::name();
+        benchmark["dataset_name"] = dataset_name;
+        benchmark["function_name"] = HashFn::name();
+        benchmark["label"] = label;
+        benchmark["thread_scaling"] = scaling;
+        function_stats(benchmark, fn);
+        std::cout << label + "\n";
+        writer.add_data(benchmark);
+    }
+
+    // successful and unsuccessful probes: half of the dataset is inserted, the other half is probed as misses
+    template <class HashFn, class HashTable, class ReductionFn = FastModulo>
+    void probe_miss(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc) {
+        // Extract variables
+        const size_t dataset_size = ds_obj.get_size();
+        const std::string dataset_name = dataset::name(ds_obj.get_id());
+        const std::vector<Data>& ds = ds_obj.get_ds();
+        const std::string label = "Probe-miss:" + HashTable::name() + ":" + dataset_name + ":" + std::to_string(load_perc);
+
+        // split the dataset (in insertion order)
+        std::vector<Data> hits, misses;
+        hits.reserve(dataset_size/2 + 1);
+        misses.reserve(dataset_size/2 + 1);
+        for (int i : order_insert) {
+            if (i < (int)dataset_size)
+                (hits.size() <= misses.size() ? hits : misses).push_back(ds[i]);
+        }
+
+        // Compute capacity given the laod% and the inserted keys (the model is trained on the whole dataset)
+        const size_t capacity = reduction::table_size<ReductionFn>(hits.size()*100/load_perc);
+        const auto model = model_cache::get<HashFn>(ds.begin(), ds.end(), capacity);
+        const HashFn& fn = *model.fn;
+        HashTable table(capacity, fn);
+
+        // ====================== throughput counters ====================== //
+        std::chrono::high_resolution_clock::time_point start_for, end_for;
+        std::chrono::duration<double> tot_for_insert(0), tot_for_hit(0), tot_for_miss(0), tot_bulk_load(0);
+        size_t insert_count = 0;
+        std::string fail_what = "";
+        bool insert_fail = false;
+        double hit_length = 0, miss_length = 0, linear_miss_length = 0;
+        // ================================================================ //
+
+        // Build the table
+        start_for = std::chrono::high_resolution_clock::now();
+        try {
+            for (; insert_count < hits.size(); insert_count++)
+                table.insert(hits[insert_count], insert_count);
+        } catch(std::runtime_error& e) {
+            insert_fail = true;
+            fail_what = e.what();
+            hits.resize(insert_count);
+        }
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_for_insert = end_for - start_for;
+
+        // probe the inserted keys, then the other ones
+        start_for = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < hits.size(); i++) {
+            if (!table.lookup(hits[i]).has_value())
+                throw std::runtime_error("\033[1;91mError\033[0m Data not found...\n           [data] " + std::to_string(hits[i]) + "\n           [label] " + label + "\n");
+        }
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_for_hit = end_for - start_for;
+        start_for = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < misses.size(); i++) {
+            if (table.lookup(misses[i]).has_value())
+                throw std::runtime_error("\033[1;91mError\033[0m Data found...\n           [data] " + std::to_string(misses[i]) + "\n           [label] " + label + "\n");
+        }
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_for_miss = end_for - start_for;
+
+        // the probe lengths, when the table exposes them
+        if constexpr (requires { table.probe_length(Key()); }) {
+            for (const Data& data : hits)
+                hit_length += table.probe_length(data);
+            for (const Data& data : misses)
+                miss_length += table.probe_length(data);
+            hit_length = hits.empty() ? 0 : hit_length / hits.size();
+            miss_length = misses.empty() ? 0 : miss_length / misses.size();
+        }
+        if constexpr (requires { table.run_length(Key()); }) {
+            for (const Data& data : misses)
+                linear_miss_length += table.run_length(data);
+            linear_miss_length = misses.empty() ? 0 : linear_miss_length / misses.size();
+        }
+        // the build from the sorted keys
+        if constexpr (requires { table.bulk_load(std::vector<Key>(), std::vector<Payload>()); }) {
+            if (!insert_fail) {
+                std::vector<Key> sorted(hits.begin(), hits.end());
+                std::sort(sorted.begin(), sorted.end());
+                std::vector<Payload> payloads(sorted.size());
+                std::iota(payloads.begin(), payloads.end(), 0);
+                HashTable loaded(capacity, fn);
+                start_for = std::chrono::high_resolution_clock::now();
+                loaded.bulk_load(sorted, payloads);
+                end_for = std::chrono::high_resolution_clock::now();
+                tot_bulk_load = end_for - start_for;
+            }
+        }
+
+        json benchmark;
+        benchmark["model_build_time_s"] = model.build_time_s;
+        benchmark["model_cached"] = model.cached;
+        benchmark["dataset_size"] = dataset_size;
+        benchmark["insert_elem_count"] = insert_count;
+        benchmark["hit_elem_count"] = hits.size();
+        benchmark["miss_elem_count"] = misses.size();
+        benchmark["tot_for_time_insert_s"] = tot_for_insert.count();
+        benchmark["tot_for_time_hit_s"] = tot_for_hit.count();
+        benchmark["tot_for_time_miss_s"] = tot_for_miss.count();
+        benchmark["load_factor_%"] = load_perc;
+        benchmark["capacity"] = capacity;
+        benchmark["reduction"] = ReductionFn::name();
+        benchmark["dataset_name"] = dataset_name;
+        benchmark["function_name"] = HashFn::name();
+        benchmark["insert_fail_message"] = fail_what;
+        benchmark["label"] = label;
+        if constexpr (requires { table.probe_length(Key()); }) {
+            benchmark["mean_hit_probe_length"] = hit_length;
+            benchmark["mean_miss_probe_length"] = miss_length;
+        }
+        if constexpr (requires { table.run_length(Key()); })
+            benchmark["mean_linear_miss_probe_length"] = linear_miss_length;
+        if constexpr (requires { table.bulk_load(std::vector<Key>(), std::vector<Payload>()); })
+            benchmark["tot_time_bulk_load_s"] = tot_bulk_load.count();
+        if constexpr (requires { table.byte_size(); })
+            benchmark["table_bytes"] = table.byte_size();
+        function_stats(benchmark, fn);
+
+        if (insert_fail)
+            std::cout << "\033[1;91mInsert failed >\033[0m " + label + "\n";
+        else std::cout << label + "\n";
+        writer.add_data(benchmark);
+    }
+
     template <class HashFn, class HashTable>
     void range_helper(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t point_query_perc, 
             size_t range_size = 0, ProbeType probe_type = ProbeType::UNIFORM) {
@@ -419,8 +808,8 @@ namespace bm {
         else capacity = dataset_size*100/RANGE_LOAD_PERC;
         
         // now, create the table
-        HashFn fn;
-        _generic_::GenericFn<HashFn>::init_fn(fn,ds.begin(),ds.end(),capacity);
+        const auto model = model_cache::get<HashFn>(ds.begin(), ds.end(), capacity);
+        const HashFn& fn = *model.fn;
         HashTable table(capacity, fn);
         const std::string label = "Range:" + table.name() + ":" + dataset_name + ":" + std::to_string(point_query_perc) + ":" + std::to_string(range_size) + ":" + probe_label;
 
@@ -495,6 +884,8 @@ namespace bm {
         
     done:
         json benchmark;
+        benchmark["model_build_time_s"] = model.build_time_s;
+        benchmark["model_cached"] = model.cached;
         benchmark["dataset_size"] = dataset_size;
         benchmark["range_size"] = range_size;
         benchmark["probe_elem_count"] = probe_count;
@@ -573,8 +964,217 @@ namespace bm {
         writer.add_data(benchmark);
     }
 
+    /**
+     * Compares the second level training algorithms of the coroutine RMI on the same sample.
+     * All of them must produce the very same model.
+     * @param entry_number the size of the sample
+    */
+    template <class RMI>
+    void rmi_train_time(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t entry_number) {
+        using Mode = rmi_coro::TrainingMode;
+        const size_t dataset_size = ds_obj.get_size();
+        const std::string dataset_name = dataset::name(ds_obj.get_id());
+        const std::vector<Data>& ds = ds_obj.get_ds();
+        const size_t actual_size = std::min(entry_number, dataset_size);
+        auto it_end = ds.begin() + actual_size;
+
+        const auto train = [&](RMI& fn, Mode mode) {
+            const auto _start_ = std::chrono::high_resolution_clock::now();
+            fn.train(ds.begin(), it_end, actual_size, mode);
+            const auto _end_ = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double>(_end_ - _start_).count();
+        };
+        RMI buckets, sequential, ranges;
+        const double buckets_time = train(buckets, Mode::BUCKETS);
+        const double sequential_time = train(sequential, Mode::SEQUENTIAL);
+        const double ranges_time = train(ranges, Mode::RANGES);
+        if (!(buckets == sequential && sequential == ranges))
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m the training algorithms built different models\n           In --> " + RMI::name() + "\n");
+        const std::string label = "Build_time_rmi:" + RMI::name() + ":" + dataset_name + ":" + std::to_string(actual_size);
+
+        json benchmark;
+        benchmark["actual_size"] = actual_size;
+        benchmark["build_time_s"] = ranges_time;
+        benchmark["build_time_buckets_s"] = buckets_time;
+        benchmark["build_time_sequential_s"] = sequential_time;
+        benchmark["build_time_ranges_s"] = ranges_time;
+        benchmark["threads"] = omp_get_max_threads();
+        benchmark["model_bytes"] = ranges.byte_size();
+        benchmark["dataset_name"] = dataset_name;
+        benchmark["label"] = label;
+        std::cout << label + "\n";
+        writer.add_data(benchmark);
+    }
+
+    /**
+     * Compares a partitioned function with the monolithic one (that is, its shard function on the whole sample):
+     * build time for an increasing number of threads, collisions and hashing throughput.
+     * @param entry_number the size of the sample
+    */
+    template <class PartitionedFn>
+    void partitioned_build_time(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t entry_number) {
+        using HashFn = typename PartitionedFn::ShardFn;
+        const size_t dataset_size = ds_obj.get_size();
+        const std::string dataset_name = dataset::name(ds_obj.get_id());
+        const std::vector<Data>& ds = ds_obj.get_ds();
+        const size_t actual_size = std::min(entry_number, dataset_size);
+        auto it_end = ds.begin() + actual_size;
+        const std::string label = "Build_time_partitioned:" + PartitionedFn::name() + ":" + dataset_name + ":" + std::to_string(actual_size);
+
+        // monolithic build
+        auto _start_ = std::chrono::high_resolution_clock::now();
+        _generic_::GenericFn<HashFn> monolithic(ds.begin(), it_end, actual_size);
+        auto _end_ = std::chrono::high_resolution_clock::now();
+        const double monolithic_time = std::chrono::duration<double>(_end_ - _start_).count();
+
+        // partitioned build, doubling the threads up to the OpenMP default
+        json scaling = json::array();
+        const size_t max_threads = omp_get_max_threads();
+        PartitionedFn fn;
+        for (size_t threads = 1; ; threads = std::min(2 * threads, max_threads)) {
+            fn = PartitionedFn();
+            _start_ = std::chrono::high_resolution_clock::now();
+            fn.train(ds.begin(), it_end, actual_size, threads);
+            _end_ = std::chrono::high_resolution_clock::now();
+            json point;
+            point["threads"] = threads;
+            point["build_time_s"] = std::chrono::duration<double>(_end_ - _start_).count();
+            scaling.push_back(point);
+            if (threads == max_threads)
+                break;
+        }
+
+        // collisions (as in the collisions experiment) and hashing time, probing in random order
+        std::vector<Data> probes(ds.begin(), it_end);
+        std::shuffle(probes.begin(), probes.end(), std::mt19937_64(42));
+        const auto evaluate = [&](const auto& f, size_t& collisions, double& time_s) {
+            std::vector<std::uint32_t> count(actual_size, 0);
+            Key sum = 0;
+            const auto _begin_ = std::chrono::high_resolution_clock::now();
+            for (const Data& data : probes)
+                sum += f(data);
+            const auto _stop_ = std::chrono::high_resolution_clock::now();
+            time_s = std::chrono::duration<double>(_stop_ - _begin_).count();
+            for (const Data& data : probes)
+                count[f(data)]++;
+            collisions = 0;
+            for (std::uint32_t c : count)
+                collisions += (c > 1) ? c : 0;
+            return sum;
+        };
+        size_t monolithic_collisions, partitioned_collisions;
+        double monolithic_hash_time, partitioned_hash_time;
+        Key _ = evaluate(monolithic, monolithic_collisions, monolithic_hash_time);
+        _ += evaluate(fn, partitioned_collisions, partitioned_hash_time);
+
+        json benchmark;
+        benchmark["actual_size"] = actual_size;
+        benchmark["shards"] = fn.shard_count();
+        benchmark["build_time_s"] = scaling.back()["build_time_s"];
+        benchmark["build_scaling"] = scaling;
+        benchmark["monolithic_build_time_s"] = monolithic_time;
+        benchmark["collisions"] = partitioned_collisions;
+        benchmark["monolithic_collisions"] = monolithic_collisions;
+        benchmark["tot_hash_time_s"] = partitioned_hash_time;
+        benchmark["monolithic_tot_hash_time_s"] = monolithic_hash_time;
+        benchmark["model_bytes"] = fn.byte_size();
+        if constexpr (requires { monolithic.function().byte_size(); })
+            benchmark["monolithic_model_bytes"] = monolithic.function().byte_size();
+        benchmark["dataset_name"] = dataset_name;
+        benchmark["function_name"] = HashFn::name();
+        benchmark["label"] = label;
+        benchmark["_"] = _; // useless, just to avoid optimizing out the lookups
+        std::cout << label + "\n";
+        writer.add_data(benchmark);
+    }
+
+    /**
+     * Tunes the size of the learned function for a dataset and a table (once per configuration),
+     * and stores the choice together with the search trace.
+    */
+    template <class Candidates>
+    tuner::Choice tune(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, tuner::Table table, size_t load_perc) {
+        const auto [choice, is_new] = tuner::tune_once<Candidates>(ds_obj, table, load_perc, TUNER_MEMORY_BUDGET, TUNER_MAX_SAMPLE);
+        if (is_new) {
+            const std::string dataset_name = dataset::name(ds_obj.get_id());
+            const std::string label = "Tune:" + tuner::name(table) + ":" + dataset_name + ":" + std::to_string(load_perc);
+            json benchmark;
+            benchmark["dataset_size"] = ds_obj.get_size();
+            benchmark["dataset_name"] = dataset_name;
+            benchmark["table"] = tuner::name(table);
+            benchmark["load_factor_%"] = load_perc;
+            benchmark["memory_budget"] = TUNER_MEMORY_BUDGET;
+            benchmark["llc_bytes"] = machine::llc_bytes();
+            benchmark["function_name"] = choice.function_name;
+            benchmark["candidates"] = choice.trace;
+            benchmark["label"] = label;
+            std::cout << label + " -> " + choice.function_name + "\n";
+            writer.add_data(benchmark);
+        }
+        return choice;
+    }
+
+    // probe throughput, with the tuned function
+    template <class Candidates, template <class> class HashTable>
+    void tuned_probe_throughput(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc, tuner::Table table,
+            ProbeType probe_type = ProbeType::UNIFORM) {
+        const tuner::Choice choice = tune<Candidates>(ds_obj, writer, table, load_perc);
+        tuner::with_candidate<Candidates>(choice.index, [&]<class HashFn>() {
+            probe_throughput<HashFn, HashTable<HashFn>>(ds_obj, writer, load_perc, probe_type);
+        });
+    }
+
+    /**
+     * Runs a single join between a build and a probe relation, and stores its results.
+     * @param label the label of the benchmark
+     * @param join_size a string describing the size of the two relations
+    */
+    template <class HashFn, class HashTable, bulk::BuildMode Mode = bulk::BuildMode::INSERT>
+    void join_run(std::vector<Key>& build_keys, std::vector<Payload>& build_payloads,
+            std::vector<Key>& probe_keys, std::vector<Payload>& probe_payloads,
+            const std::string& dataset_name, const std::string& label, const std::string& join_size, JsonOutput& writer,
+            /* perf stuff */ std::string perf_config = "", std::ostream& perf_out = std::cout) {
+        // prepare output arrays
+        std::vector<Key> keys_out;
+        std::vector<std::pair<Payload,Payload>> payloads_out;
+        const size_t build_size = build_keys.size();
+        const size_t probe_size = probe_keys.size();
+
+        auto time = join::npj_hash<Key,Payload,HashFn,HashTable,JOIN_LOAD_PERC,Mode>(
+            build_keys, build_payloads, probe_keys, probe_payloads, keys_out, payloads_out,
+            /* perf things */ is_perf, perf_config+join_size+",", perf_out
+        );
+        if (time.has_value() && keys_out.size()!=probe_size) {
+            throw std::runtime_error("\033[1;91mError!\033[0m join operation didn't find all pairs\n           In --> " + label + " (" + join_size + ")\n           [keys_out.size()] " + std::to_string(keys_out.size()) + "\n");
+        }
+        json benchmark;
+        benchmark["join_size"] = "(" + join_size + ")";
+        benchmark["build_size"] = build_size;
+        benchmark["probe_size"] = probe_size;
+        benchmark["dataset_name"] = dataset_name;
+        benchmark["function_name"] = HashFn::name();
+        // (the concurrent tables are built and probed by all the OpenMP threads, see npj_hash)
+        benchmark["threads"] = join::is_concurrent<HashTable>() ? omp_get_max_threads() : 1;
+        benchmark["build_mode"] = bulk::name<HashTable,Key,Payload>(Mode);
+        benchmark["label"] = label;
+        if (!time.has_value()) {
+            std::cout << "\033[1;91mInsert failed >\033[0m " + label + "\t[ " + join_size + " ]\n";
+            benchmark["has_failed"] = true;
+        }
+        else {
+            std::cout << label + "\t[ " + join_size + " ]\n";
+            benchmark["has_failed"] = false;
+            benchmark["tot_time_build_s"] = std::get<1>(time.value()).count();
+            benchmark["tot_time_join_s"] = std::get<2>(time.value()).count();
+            benchmark["tot_time_sort_s"] = std::get<0>(time.value()).count();
+            benchmark["model_build_time_s"] = std::get<3>(time.value());
+            benchmark["model_cached"] = std::get<4>(time.value());
+        }
+        writer.add_data(benchmark);
+    }
+
     // join throughput helper
-    template <class HashFn, class HashTable>
+    template <class HashFn, class HashTable, bulk::BuildMode Mode = bulk::BuildMode::INSERT>
     void join_helper(const dataset::Dataset<Key>& ds_obj, JsonOutput& writer,
             /* perf stuff */ std::string perf_config = "", std::ostream& perf_out = std::cout) {
         // Extract variables
@@ -582,7 +1182,11 @@ namespace bm {
         const std::string dataset_name = dataset::name(ds_obj.get_id());
         const std::vector<Key>& ds = ds_obj.get_ds();
 
-        const std::string label = "Join:" + HashTable::name() + ":" + HashFn::name() + ":" + dataset_name;
+        std::string label = "Join:" + HashTable::name() + ":" + HashFn::name() + ":" + dataset_name;
+        if constexpr (join::is_concurrent<HashTable>())
+            label += ":" + std::to_string(omp_get_max_threads()) + "_threads";
+        if (Mode != bulk::BuildMode::INSERT)
+            label += ":" + bulk::name<HashTable,Key,Payload>(Mode);
 
         // do 10M and 25M variants
         std::vector<Key> keys_10M;
@@ -627,68 +1231,51 @@ namespace bm {
             keys_25M_dup[i] = keys_25M[rand_idx_25M];
         }
 
-        // prepare output arrays
-        std::vector<Key> keys_out;
-        std::vector<std::pair<Payload,Payload>> payloads_out;
-        
         // ******************** 10x25 ******************** //
-        auto time_10_25 = join::npj_hash<Key,Payload,HashFn,HashTable,JOIN_LOAD_PERC>(
-            keys_10M, payloads_10M, keys_10M_dup, payloads_25M, keys_out, payloads_out,
-            /* perf things */ is_perf, perf_config+"10Mx25M,", perf_out
-        );
-        if (time_10_25.has_value() && keys_out.size()!=M(25)) {
-            throw std::runtime_error("\033[1;91mError!\033[0m join operation didn't find all pairs\n           In --> " + label + " (10Mx25M)\n           [keys_out.size()] " + std::to_string(keys_out.size()) + "\n");
-        }
-        json benchmark_10_25;
-        benchmark_10_25["join_size"] = "(10Mx25M)";
-        benchmark_10_25["dataset_name"] = dataset_name;
-        benchmark_10_25["function_name"] = HashFn::name();
-        benchmark_10_25["label"] = label;
-        if (!time_10_25.has_value()) {
-            std::cout << "\033[1;91mInsert failed >\033[0m " + label + "\t[ 10M x 25M ]\n";
-            benchmark_10_25["has_failed"] = true;
-        }
-        else {
-            std::cout << label + "\t[ 10M x 25M ]\n";
-            benchmark_10_25["has_failed"] = false;
-            benchmark_10_25["tot_time_build_s"] = std::get<1>(time_10_25.value()).count();
-            benchmark_10_25["tot_time_join_s"] = std::get<2>(time_10_25.value()).count();
-            benchmark_10_25["tot_time_sort_s"] = std::get<0>(time_10_25.value()).count();
-        }
-        writer.add_data(benchmark_10_25);
-
+        join_run<HashFn,HashTable,Mode>(keys_10M, payloads_10M, keys_10M_dup, payloads_25M, dataset_name, label, "10Mx25M", writer, perf_config, perf_out);
         // ******************** 25x25 ******************** //
-        keys_out.clear();
-        payloads_out.clear();
-        auto time_25_25 = join::npj_hash<Key,Payload,HashFn,HashTable,JOIN_LOAD_PERC>(
-            keys_25M, payloads_25M, keys_25M_dup, payloads_25M, keys_out, payloads_out,
-            /* perf things */ is_perf, perf_config+"25Mx25M,", perf_out    
-        );
-        if (time_25_25.has_value() && keys_out.size()!=M(25)) {
-            throw std::runtime_error("\033[1;91mError!\033[0m join operation didn't find all pairs\n           In --> " + label + " (25Mx25M)\n           [keys_out.size()] " + std::to_string(keys_out.size()) + "\n");
-        }
-        json benchmark_25_25;
-        benchmark_25_25["join_size"] = "(25Mx25M)";
-        benchmark_25_25["dataset_name"] = dataset_name;
-        benchmark_25_25["function_name"] = HashFn::name();
-        benchmark_25_25["label"] = label;
-        if (!time_25_25.has_value()) {
-            std::cout << "\033[1;91mInsert failed >\033[0m " + label + "\t[ 25M x 25M ]\n";
-            benchmark_25_25["has_failed"] = true;
-        }
-        else {
-            std::cout << label + "\t[ 25M x 25M ]\n";
-            benchmark_25_25["has_failed"] = false;
-            benchmark_25_25["tot_time_build_s"] = std::get<1>(time_25_25.value()).count();
-            benchmark_25_25["tot_time_join_s"] = std::get<2>(time_25_25.value()).count();
-            benchmark_25_25["tot_time_sort_s"] = std::get<0>(time_25_25.value()).count();
-        }
-        writer.add_data(benchmark_25_25);
+        join_run<HashFn,HashTable,Mode>(keys_25M, payloads_25M, keys_25M_dup, payloads_25M, dataset_name, label, "25Mx25M", writer, perf_config, perf_out);
     }
     // join throughput
-    template <class HashFn, class HashTable>
+    template <class HashFn, class HashTable, bulk::BuildMode Mode = bulk::BuildMode::INSERT>
     inline void join_throughput(const dataset::Dataset<Key>& ds_obj, JsonOutput& writer) { 
-        join_helper<HashFn,HashTable>(ds_obj, writer);
+        join_helper<HashFn,HashTable,Mode>(ds_obj, writer);
+    }
+    // join throughput, with the tuned function
+    template <class Candidates, template <class> class HashTable>
+    void tuned_join_throughput(const dataset::Dataset<Key>& ds_obj, JsonOutput& writer, tuner::Table table) {
+        const tuner::Choice choice = tune<Candidates>(ds_obj, writer, table, JOIN_LOAD_PERC);
+        tuner::with_candidate<Candidates>(choice.index, [&]<class HashFn>() {
+            join_helper<HashFn, HashTable<HashFn>>(ds_obj, writer);
+        });
+    }
+    // join throughput, on a random sample of the dataset
+    template <class HashFn, class HashTable>
+    void join_size(const dataset::Dataset<Key>& ds_obj, JsonOutput& writer, size_t sample_size) {
+        dataset::Dataset<Key> sample(ds_obj, sample_size);
+        const std::vector<Key>& ds = sample.get_ds();
+        const std::string dataset_name = dataset::name(ds_obj.get_id());
+        const std::string label = "Join-size:" + HashTable::name() + ":" + HashFn::name() + ":" + dataset_name + ":" + std::to_string(sample.get_size());
+
+        // the build side is the whole sample, the probe side picks its keys uniformly from it
+        std::vector<int> insert_order, probe_order;
+        make_sweep_orders(sample.get_size(), insert_order, probe_order);
+        std::vector<Key> build_keys, probe_keys;
+        std::vector<Payload> build_payloads, probe_payloads;
+        build_keys.reserve(insert_order.size());
+        build_payloads.reserve(insert_order.size());
+        probe_keys.reserve(probe_order.size());
+        probe_payloads.reserve(probe_order.size());
+        for (size_t i=0; i<insert_order.size(); i++) {
+            build_keys.push_back(ds[insert_order[i]]);
+            build_payloads.push_back(i);
+        }
+        for (size_t i=0; i<probe_order.size(); i++) {
+            probe_keys.push_back(ds[probe_order[i]]);
+            probe_payloads.push_back(i);
+        }
+        const std::string size_tag = std::to_string(build_keys.size()) + "x" + std::to_string(probe_keys.size());
+        join_run<HashFn,HashTable>(build_keys, build_payloads, probe_keys, probe_payloads, dataset_name, label, size_tag, writer);
     }
 
     // ********************** COROUTINES ********************** //
@@ -703,6 +1290,24 @@ namespace bm {
     //         }
     //     }
     // }
+    /**
+     * Adds a dTLB load misses counter to `e` (to measure the effect of huge pages).
+     * Read it with e.getCounter(DTLB_COUNTER) after stopCounters().
+    */
+    const std::string DTLB_COUNTER = "dTLB-load-misses";
+    inline static void register_dtlb_counter(PerfEvent& e) {
+        e.registerCounter(DTLB_COUNTER, PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    }
+    /**
+     * @return whether the overflow buckets of CoroTable are allocated from an arena
+    */
+    template <class CoroTable>
+    constexpr bool bucket_arena() {
+        if constexpr (requires { CoroTable::BUCKET_ARENA; })
+            return CoroTable::BUCKET_ARENA;
+        else return false;
+    }
     inline static void make_lookup_vector(std::vector<Data> const &ds, std::vector<Data>& lookup, std::vector<int> const *order_probe, size_t *count) {
         size_t dataset_size = ds.size();
         lookup.reserve(dataset_size);
@@ -744,38 +1349,24 @@ namespace bm {
         *count = _count_;
     }
 
-    // probe coroutines
+    // probe coroutines helper
     template <class HashFn, class CoroTable = ChainedTableCoro<HashFn>>
-    void probe_coroutines(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc, ProbeType probe_type,
+    void coro_helper(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc,
+            const std::vector<int>& insert_order, const std::vector<int>& probe_order, const std::string& probe_label, const std::string& label,
             /* coroutines stuff */ size_t n_coro) {
         // Extract variables
         const size_t dataset_size = ds_obj.get_size();
         const std::string dataset_name = dataset::name(ds_obj.get_id());
         const std::vector<Data>& ds = ds_obj.get_ds();
 
-        // Choose probe distribution
-        std::vector<int>* order_probe = nullptr;
-        std::string probe_label;
-        switch(probe_type) {
-            case ProbeType::UNIFORM:
-                order_probe = &order_probe_uniform;
-                probe_label = "uniform";
-                break;
-            case ProbeType::PARETO_80_20:
-                order_probe = &order_probe_80_20;
-                probe_label = "80-20";
-        }
-
-        const std::string label = "Coro:" + HashFn::name() + ":" + dataset_name + ":" + std::to_string(load_perc) + ":" + probe_label + ":" + std::to_string(n_coro);
-
         std::cout << "BEGIN " + label + "\n";
 
         // Compute capacity given the laod% and the dataset_size
         std::size_t capacity = dataset_size*100/load_perc;
         
         // now, create the table
-        HashFn fn;
-        _generic_::GenericFn<HashFn>::init_fn(fn,ds.begin(),ds.end(),capacity);
+        const auto model = model_cache::get<HashFn>(ds.begin(), ds.end(), capacity);
+        const HashFn& fn = *model.fn;
         CoroTable table(capacity, fn);
         
         // ====================== throughput counters ====================== //
@@ -791,7 +1382,7 @@ namespace bm {
         bool done = true;
         Payload count = 0;
         start_for = std::chrono::high_resolution_clock::now();
-        for (int i : order_insert) {
+        for (int i : insert_order) {
             // check if the index exists
             if (i < (int)dataset_size) {
                 // get the data
@@ -815,12 +1406,19 @@ namespace bm {
         // prepare lookup and output arrays   
         std::vector<ResultType> results{};
         std::vector<Data> lookup;
-        make_lookup_vector(ds, lookup, order_probe, &probe_count);
+        make_lookup_vector(ds, lookup, &probe_order, &probe_count);
         results.reserve(probe_count);
 
+        PerfEvent e(true);
+        register_dtlb_counter(e);
+        double dtlb_interleaved, dtlb_sequential;
+
+        e.startCounters();
         start_for = std::chrono::high_resolution_clock::now();
         table.interleaved_multilookup(lookup.begin(), lookup.end(), std::back_inserter(results), n_coro);
         end_for = std::chrono::high_resolution_clock::now();
+        e.stopCounters();
+        dtlb_interleaved = e.getCounter(DTLB_COUNTER);
         tot_for_interleaved = end_for - start_for;
 
         // check if everything went well!
@@ -832,9 +1430,12 @@ namespace bm {
         results.clear();
         results.reserve(probe_count);
 
+        e.startCounters();
         start_for = std::chrono::high_resolution_clock::now();
         table.sequential_multilookup(lookup.begin(), lookup.end(), std::back_inserter(results));
         end_for = std::chrono::high_resolution_clock::now();
+        e.stopCounters();
+        dtlb_sequential = e.getCounter(DTLB_COUNTER);
         tot_for_sequential = end_for - start_for;
 
         // check if everything went well!
@@ -843,7 +1444,17 @@ namespace bm {
         }
         std::cout << " |- [t] sequential lookup: " << tot_for_sequential.count() << "s\n";
 
+        // teardown (the destructor would do the same)
+        const size_t table_bytes = table.byte_size();
+        start_for = std::chrono::high_resolution_clock::now();
+        table.clear();
+        end_for = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double> tot_time_clear = end_for - start_for;
+        std::cout << " |- [t] clear: " << tot_time_clear.count() << "s\n";
+
         json benchmark;
+        benchmark["model_build_time_s"] = model.build_time_s;
+        benchmark["model_cached"] = model.cached;
         benchmark["dataset_size"] = dataset_size;
         benchmark["probe_elem_count"] = probe_count;
         benchmark["insert_elem_count"] = insert_count;
@@ -858,6 +1469,13 @@ namespace bm {
         benchmark["label"] = label;
         benchmark["probe_type"] = probe_label;
         benchmark["n_coro"] = n_coro;
+        benchmark["huge_pages"] = mem::name(mem::obtained_pages<CoroTable>());
+        benchmark["model_huge_pages"] = mem::name(mem::obtained_pages<HashFn>());
+        benchmark["dtlb_load_misses_interleaved"] = dtlb_interleaved;
+        benchmark["dtlb_load_misses_sequential"] = dtlb_sequential;
+        benchmark["tot_time_clear_s"] = tot_time_clear.count();
+        benchmark["table_bytes"] = table_bytes;
+        benchmark["bucket_arena"] = bucket_arena<CoroTable>();
 
         if (insert_fail)
             std::cout << " `- \033[1;91mInsert failed\033[0m\n";
@@ -865,6 +1483,47 @@ namespace bm {
         writer.add_data(benchmark);
     }
 
+    // probe coroutines
+    template <class HashFn, class CoroTable = ChainedTableCoro<HashFn>>
+    void probe_coroutines(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc, ProbeType probe_type,
+            /* coroutines stuff */ size_t n_coro) {
+        // Choose probe distribution
+        std::vector<int>* order_probe = nullptr;
+        std::string probe_label;
+        switch(probe_type) {
+            case ProbeType::UNIFORM:
+                order_probe = &order_probe_uniform;
+                probe_label = "uniform";
+                break;
+            case ProbeType::PARETO_80_20:
+                order_probe = &order_probe_80_20;
+                probe_label = "80-20";
+        }
+        const std::string label = "Coro:" + HashFn::name() + (bucket_arena<CoroTable>() ? "_arena" : "") + ":" + dataset::name(ds_obj.get_id()) + ":" + std::to_string(load_perc) + ":" + probe_label + ":" + std::to_string(n_coro);
+        coro_helper<HashFn,CoroTable>(ds_obj, writer, load_perc, order_insert, *order_probe, probe_label, label, n_coro);
+    }
+
+    // probe coroutines, with the tuned function (on a chained table)
+    template <class Candidates>
+    void tuned_probe_coroutines(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc, ProbeType probe_type,
+            /* coroutines stuff */ size_t n_coro) {
+        const tuner::Choice choice = tune<Candidates>(ds_obj, writer, tuner::Table::CHAINED, load_perc);
+        tuner::with_candidate<Candidates>(choice.index, [&]<class HashFn>() {
+            probe_coroutines<HashFn>(ds_obj, writer, load_perc, probe_type, n_coro);
+        });
+    }
+
+    // probe coroutines, on a random sample of the dataset
+    template <class HashFn, class CoroTable = ChainedTableCoro<HashFn>>
+    void probe_coroutines_size(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t sample_size,
+            /* coroutines stuff */ size_t n_coro) {
+        dataset::Dataset<Data> sample(ds_obj, sample_size);
+        std::vector<int> insert_order, probe_order;
+        make_sweep_orders(sample.get_size(), insert_order, probe_order);
+        const std::string label = "Coro-size:" + HashFn::name() + ":" + dataset::name(ds_obj.get_id()) + ":" + std::to_string(sample.get_size()) + ":" + std::to_string(SWEEP_CHAINED_LF) + ":" + std::to_string(n_coro);
+        coro_helper<HashFn,CoroTable>(sample, writer, SWEEP_CHAINED_LF, insert_order, probe_order, "uniform", label, n_coro);
+    }
+
     // probe coroutines
     template <class HashFn, class CoroTable = ChainedTableCoro<HashFn>>
     void batch_coroutines(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc, ProbeType probe_type,
@@ -895,8 +1554,8 @@ namespace bm {
         std::size_t capacity = dataset_size*100/load_perc;
         
         // now, create the table
-        HashFn fn;
-        _generic_::GenericFn<HashFn>::init_fn(fn,ds.begin(),ds.end(),capacity);
+        const auto model = model_cache::get<HashFn>(ds.begin(), ds.end(), capacity);
+        const HashFn& fn = *model.fn;
         CoroTable table(capacity, fn);
         
         // ====================== throughput counters ====================== //
@@ -987,6 +1646,8 @@ namespace bm {
         std::cout << " |- [t] sequential lookup: " << tot_for_sequential.count() << "s\n";
 
         json benchmark;
+        benchmark["model_build_time_s"] = model.build_time_s;
+        benchmark["model_cached"] = model.cached;
         benchmark["dataset_size"] = dataset_size;
         benchmark["probe_elem_count"] = probe_count;
         benchmark["batch_number"] = std::ceil(probe_count/n_coro);
@@ -1009,6 +1670,116 @@ namespace bm {
         writer.add_data(benchmark);
     }
 
+    // probe with batched hashing
+    template <class HashFn, class Table = ChainedTableCoro<HashFn>>
+    void probe_batch(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer, size_t load_perc, ProbeType probe_type) {
+        // Extract variables
+        const size_t dataset_size = ds_obj.get_size();
+        const std::string dataset_name = dataset::name(ds_obj.get_id());
+        const std::vector<Data>& ds = ds_obj.get_ds();
+
+        // Choose probe distribution
+        std::vector<int>* order_probe = nullptr;
+        std::string probe_label;
+        switch(probe_type) {
+            case ProbeType::UNIFORM:
+                order_probe = &order_probe_uniform;
+                probe_label = "uniform";
+                break;
+            case ProbeType::PARETO_80_20:
+                order_probe = &order_probe_80_20;
+                probe_label = "80-20";
+        }
+
+        const std::string label = "Probe-batch:" + Table::name() + ":" + dataset_name + ":" + std::to_string(load_perc) + ":" + probe_label;
+
+        // Compute capacity given the laod% and the dataset_size
+        std::size_t capacity = dataset_size*100/load_perc;
+        
+        // now, create the table
+        const auto model = model_cache::get<HashFn>(ds.begin(), ds.end(), capacity);
+        const HashFn& fn = *model.fn;
+        Table table(capacity, fn);
+        // same function, used to hash the batches
+        _generic_::GenericFn<HashFn> batch_fn(fn, capacity);
+
+        // ====================== throughput counters ====================== //
+        /*volatile*/ std::chrono::high_resolution_clock::time_point start_for, end_for;
+        /*volatile*/ std::chrono::duration<double> tot_for_sequential(0), tot_for_hash(0), tot_for_table(0);
+        size_t probe_count = 0;
+        // ================================================================ //
+
+        // Build the table
+        bool done = true;
+        Payload count = 0;
+        for (int i : order_insert) {
+            // check if the index exists
+            if (i < (int)dataset_size) {
+                done &= table.insert(ds[i], count);
+                count++;
+            }
+        }
+        // check if everything went well!
+        if (!done) {
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m done\n           In --> " + label + "\n");
+        }
+
+        // prepare lookup and output arrays   
+        std::vector<ResultType> results{};
+        std::vector<Data> lookup;
+        make_lookup_vector(ds, lookup, order_probe, &probe_count);
+        results.reserve(probe_count);
+
+        // hash and table access interleaved (the usual lookup)
+        start_for = std::chrono::high_resolution_clock::now();
+        table.sequential_multilookup(lookup.begin(), lookup.end(), std::back_inserter(results));
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_for_sequential = end_for - start_for;
+
+        // check if everything went well!
+        if (results.size() != probe_count) {
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m results.size()==probe_count\n           In --> " + label + "\n           [results.size()] " + std::to_string(results.size()) + "\n           [probe_count] " + std::to_string(probe_count) + "\n");
+        }
+        results.clear();
+        results.reserve(probe_count);
+
+        // first hash everything, then access the table
+        std::vector<Key> indexes(probe_count);
+        start_for = std::chrono::high_resolution_clock::now();
+        batch_fn.hash_batch(lookup.data(), indexes.data(), probe_count);
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_for_hash = end_for - start_for;
+
+        start_for = std::chrono::high_resolution_clock::now();
+        table.batch_multilookup(lookup.begin(), lookup.end(), indexes.begin(), std::back_inserter(results));
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_for_table = end_for - start_for;
+
+        // check if everything went well!
+        size_t found = std::count_if(results.begin(), results.end(), [](const ResultType& r) { return (bool)r; });
+        if (found != probe_count) {
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m found==probe_count\n           In --> " + label + "\n           [found] " + std::to_string(found) + "\n           [probe_count] " + std::to_string(probe_count) + "\n");
+        }
+
+        json benchmark;
+        benchmark["model_build_time_s"] = model.build_time_s;
+        benchmark["model_cached"] = model.cached;
+        benchmark["dataset_size"] = dataset_size;
+        benchmark["probe_elem_count"] = probe_count;
+        benchmark["tot_for_time_sequential_s"] = tot_for_sequential.count();
+        benchmark["tot_for_time_hash_s"] = tot_for_hash.count();
+        benchmark["tot_for_time_table_s"] = tot_for_table.count();
+        benchmark["batch_vectorized"] = batch_fn.is_batch_vectorized();
+        benchmark["batch_reduction_vectorized"] = batch_fn.is_batch_reduction_vectorized();
+        benchmark["load_factor_%"] = load_perc;
+        benchmark["dataset_name"] = dataset_name;
+        benchmark["function_name"] = HashFn::name();
+        benchmark["label"] = label;
+        benchmark["probe_type"] = probe_label;
+        std::cout << label + "\n";
+        writer.add_data(benchmark);
+    }
+
     // RMI coro
     template <class RMI>
     void rmi_coro_throughput(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer,
@@ -1038,10 +1809,17 @@ namespace bm {
             throw std::runtime_error("\033[1;91mAssertion failed\033[0m dataset_size==insert_count\n           In --> " + label + "\n           [dataset_size] " + std::to_string(dataset_size) + "\n           [insert_count] " + std::to_string(insert_count) + "\n");
         }
         
+        PerfEvent e(true);
+        register_dtlb_counter(e);
+        double dtlb_interleaved, dtlb_sequential;
+
         // sequential
+        e.startCounters();
         start_for = std::chrono::high_resolution_clock::now();
         fn.sequential_multihash(lookup.begin(), lookup.end(), std::back_inserter(results));
         end_for = std::chrono::high_resolution_clock::now();
+        e.stopCounters();
+        dtlb_sequential = e.getCounter(DTLB_COUNTER);
         tot_sequential = end_for - start_for;
 
         // check if everything went well!
@@ -1052,9 +1830,12 @@ namespace bm {
         results.reserve(dataset_size);
 
         // interleaved
+        e.startCounters();
         start_for = std::chrono::high_resolution_clock::now();
         fn.interleaved_multihash(lookup.begin(), lookup.end(), std::back_inserter(results), n_coro);
         end_for = std::chrono::high_resolution_clock::now();
+        e.stopCounters();
+        dtlb_interleaved = e.getCounter(DTLB_COUNTER);
         tot_interleaved = end_for - start_for;
 
         // check if everything went well!
@@ -1070,8 +1851,182 @@ namespace bm {
         benchmark["dataset_name"] = dataset_name;
         benchmark["label"] = label;
         benchmark["n_coro"] = n_coro; 
+        benchmark["huge_pages"] = mem::name(mem::obtained_pages<RMI>());
+        benchmark["dtlb_load_misses_interleaved"] = dtlb_interleaved;
+        benchmark["dtlb_load_misses_sequential"] = dtlb_sequential;
         std::cout << label + "\n";
         writer.add_data(benchmark);
     }
     
+    // RMI batch (SoA models + SIMD gathers)
+    template <class RMI>
+    void rmi_batch_throughput(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer,
+            /* coroutines stuff */ size_t n_coro) {
+        // Extract variables
+        const size_t dataset_size = ds_obj.get_size();
+        const std::string dataset_name = dataset::name(ds_obj.get_id());
+        const std::vector<Data>& ds = ds_obj.get_ds();
+
+        RMI fn(ds.begin(), ds.end(), dataset_size);
+        rmi_coro::RMIBatch<RMI> batch_fn(fn);
+        const std::string label = "Batch-RMI:" + fn.name() + ":" + dataset_name + ":" + std::to_string(n_coro);
+
+        // ====================== throughput counters ====================== //
+        /*volatile*/ std::chrono::high_resolution_clock::time_point start_for, end_for;
+        /*volatile*/ std::chrono::duration<double> tot_sequential(0), tot_interleaved(0), tot_batch(0);
+        size_t insert_count = 0;
+        // ================================================================ //
+
+        // prepare lookup and output arrays   
+        std::vector<ResultRMIType<RMI>> results{};
+        results.reserve(dataset_size);
+
+        std::vector<Data> lookup;
+        make_lookup_vector(ds, lookup, &order_insert, &insert_count);
+        // check if everything went well!
+        if (insert_count != dataset_size) {
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m dataset_size==insert_count\n           In --> " + label + "\n           [dataset_size] " + std::to_string(dataset_size) + "\n           [insert_count] " + std::to_string(insert_count) + "\n");
+        }
+
+        // interleaved
+        start_for = std::chrono::high_resolution_clock::now();
+        fn.interleaved_multihash(lookup.begin(), lookup.end(), std::back_inserter(results), n_coro);
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_interleaved = end_for - start_for;
+
+        // check if everything went well!
+        if (results.size() != dataset_size) {
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m results.size()==dataset_size\n           In --> " + label + "\n           [results.size()] " + std::to_string(results.size()) + "\n           [dataset_size] " + std::to_string(dataset_size) + "\n");
+        }
+        results.clear();
+        results.reserve(dataset_size);
+
+        // sequential (kept as reference)
+        start_for = std::chrono::high_resolution_clock::now();
+        fn.sequential_multihash(lookup.begin(), lookup.end(), std::back_inserter(results));
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_sequential = end_for - start_for;
+
+        // check if everything went well!
+        if (results.size() != dataset_size) {
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m results.size()==dataset_size\n           In --> " + label + "\n           [results.size()] " + std::to_string(results.size()) + "\n           [dataset_size] " + std::to_string(dataset_size) + "\n");
+        }
+
+        // batch
+        std::vector<size_t> hashes(dataset_size);
+        start_for = std::chrono::high_resolution_clock::now();
+        batch_fn.hash_batch(lookup.data(), hashes.data(), dataset_size);
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_batch = end_for - start_for;
+
+        // the batched hashes must match the scalar ones
+        // (e.g., they do not if the compiler fused the scalar multiply-add into an FMA)
+        size_t mismatches = 0;
+        for (size_t i = 0; i < dataset_size; i++)
+            mismatches += (hashes[i] != results[i].get_value());
+        if (mismatches) {
+            throw std::runtime_error("\033[1;91mError\033[0m Batched hashes differ from the scalar ones...\n           [mismatches] " + std::to_string(mismatches) + "\n           [label] " + label + "\n");
+        }
+
+        json benchmark;
+
+        benchmark["dataset_size"] = dataset_size;
+        benchmark["tot_interleaved_time_s"] = tot_interleaved.count();
+        benchmark["tot_sequential_time_s"] = tot_sequential.count();
+        benchmark["tot_batch_time_s"] = tot_batch.count();
+        benchmark["batch_isa"] = batch_fn.isa();
+        benchmark["dataset_name"] = dataset_name;
+        benchmark["label"] = label;
+        benchmark["n_coro"] = n_coro; 
+        std::cout << label + "\n";
+        writer.add_data(benchmark);
+    }
+    
+    // RMI precision (double vs float vs fixed point second level models)
+    template <class RMI, class ReferenceRMI>
+    void rmi_precision(const dataset::Dataset<Data>& ds_obj, JsonOutput& writer,
+            /* coroutines stuff */ size_t n_coro) {
+        // Extract variables
+        const size_t dataset_size = ds_obj.get_size();
+        const std::string dataset_name = dataset::name(ds_obj.get_id());
+        const std::vector<Data>& ds = ds_obj.get_ds();
+
+        RMI fn(ds.begin(), ds.end(), dataset_size);
+        ReferenceRMI reference_fn(ds.begin(), ds.end(), dataset_size);
+        const std::string label = "Precision-RMI:" + fn.name() + ":" + dataset_name + ":" + std::to_string(n_coro);
+
+        // ====================== throughput counters ====================== //
+        /*volatile*/ std::chrono::high_resolution_clock::time_point start_for, end_for;
+        /*volatile*/ std::chrono::duration<double> tot_sequential(0), tot_interleaved(0);
+        size_t insert_count = 0;
+        // ================================================================ //
+
+        // prepare lookup and output arrays   
+        std::vector<ResultRMIType<RMI>> results{};
+        results.reserve(dataset_size);
+
+        std::vector<Data> lookup;
+        make_lookup_vector(ds, lookup, &order_insert, &insert_count);
+        // check if everything went well!
+        if (insert_count != dataset_size) {
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m dataset_size==insert_count\n           In --> " + label + "\n           [dataset_size] " + std::to_string(dataset_size) + "\n           [insert_count] " + std::to_string(insert_count) + "\n");
+        }
+
+        // interleaved
+        start_for = std::chrono::high_resolution_clock::now();
+        fn.interleaved_multihash(lookup.begin(), lookup.end(), std::back_inserter(results), n_coro);
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_interleaved = end_for - start_for;
+        results.clear();
+        results.reserve(dataset_size);
+
+        // sequential
+        start_for = std::chrono::high_resolution_clock::now();
+        fn.sequential_multihash(lookup.begin(), lookup.end(), std::back_inserter(results));
+        end_for = std::chrono::high_resolution_clock::now();
+        tot_sequential = end_for - start_for;
+
+        // check if everything went well!
+        if (results.size() != dataset_size) {
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m results.size()==dataset_size\n           In --> " + label + "\n           [results.size()] " + std::to_string(results.size()) + "\n           [dataset_size] " + std::to_string(dataset_size) + "\n");
+        }
+
+        // collisions (load factor 100%) and distance from the double precision outputs
+        std::vector<Key> keys_count(dataset_size, 0);
+        size_t collisions_count = 0;
+        size_t max_diff = 0;
+        double tot_diff = 0;
+        for (const auto& res : results) {
+            const size_t hash = res.get_value();
+            if (hash >= dataset_size) {
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m hash<dataset_size\n           In --> " + label + "\n           [hash] " + std::to_string(hash) + "\n           [dataset_size] " + std::to_string(dataset_size) + "\n");
+            }
+            keys_count[hash]++;
+            const size_t reference = reference_fn(res.get_key());
+            const size_t diff = hash > reference ? hash - reference : reference - hash;
+            max_diff = std::max(max_diff, diff);
+            tot_diff += diff;
+        }
+        for (auto k : keys_count) {
+            if (k > 1)
+                collisions_count += k;
+        }
+
+        json benchmark;
+
+        benchmark["dataset_size"] = dataset_size;
+        benchmark["tot_interleaved_time_s"] = tot_interleaved.count();
+        benchmark["tot_sequential_time_s"] = tot_sequential.count();
+        benchmark["collisions"] = collisions_count;
+        benchmark["model_bytes"] = fn.byte_size();
+        benchmark["reference_model_bytes"] = reference_fn.byte_size();
+        benchmark["max_diff_from_reference"] = max_diff;
+        benchmark["avg_diff_from_reference"] = tot_diff / dataset_size;
+        benchmark["dataset_name"] = dataset_name;
+        benchmark["label"] = label;
+        benchmark["n_coro"] = n_coro; 
+        std::cout << label + "\n";
+        writer.add_data(benchmark);
+    }
+
 }
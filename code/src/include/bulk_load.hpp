@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Building a table from keys sorted in advance
+// A table is normally built with one insert(key, payload) per key, in random order. With a monotone (learned) hash
+// function, sorted keys map to non-decreasing slots: a build in key order writes the table in one sequential pass,
+// which the hardware prefetcher follows. The tables knowing how to exploit it (e.g. by preallocating their chains)
+// expose a bulk_load(keys, payloads) method; the others are filled inserting the keys in sorted order.
+
+namespace bulk {
+
+    // how a benchmark builds its table
+    enum class BuildMode { INSERT, BULK_LOAD };
+
+    // whether HashTable has its own bulk_load(keys, payloads)
+    template <class HashTable, class Key, class Payload>
+    constexpr bool has_bulk_load() {
+        return requires(HashTable& table, const std::vector<Key>& keys, const std::vector<Payload>& payloads) {
+            table.bulk_load(keys, payloads);
+        };
+    }
+
+    /**
+     * The build actually run for HashTable in the given mode: "insert", "bulk_load", or "sorted_insert" (BULK_LOAD on
+     * a table without a bulk_load method, see load).
+    */
+    template <class HashTable, class Key, class Payload>
+    std::string name(const BuildMode mode) {
+        if (mode == BuildMode::INSERT)
+            return "insert";
+        return has_bulk_load<HashTable, Key, Payload>() ? "bulk_load" : "sorted_insert";
+    }
+
+    /**
+     * Fills an empty table with sorted keys, through its bulk_load method if it has one.
+     * Throws if the table throws (e.g. a full linear probing table).
+     * @param table the empty table
+     * @param keys the keys, in increasing order
+     * @param payloads the correspondent values
+    */
+    template <class HashTable, class Key, class Payload>
+    void load(HashTable& table, const std::vector<Key>& keys, const std::vector<Payload>& payloads) {
+        if constexpr (has_bulk_load<HashTable, Key, Payload>())
+            table.bulk_load(keys, payloads);
+        else {
+            for (size_t i = 0; i < keys.size(); i++)
+                table.insert(keys[i], payloads[i]);
+        }
+    }
+
+}   // namespace bulk
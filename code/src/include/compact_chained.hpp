@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "builtins.hpp"
+
+// A chained table with 32-bit links
+// As in the Chained table, the first pair of each chain is stored in its directory slot; the overflow buckets live in
+// a single contiguous array, and chains link them by index instead of by pointer. With 8-byte keys and payloads,
+// a directory slot takes 20 bytes (instead of 24) and a bucket of 3 pairs fits in a cache line.
+
+namespace hashtable {
+
+    template <class Key, class Payload, size_t BucketSize, class HashFn, class ReductionFn,
+              Key Sentinel = std::numeric_limits<Key>::max()>
+    class CompactChained {
+
+        using Index = std::uint32_t;
+        static constexpr Index NONE = std::numeric_limits<Index>::max();
+
+        struct Slot {
+            Key key = Sentinel;
+            Payload payload;
+        } packit;
+
+        struct Bucket {
+            Slot slots[BucketSize];
+            Index next = NONE;      // in `buckets`
+        } packit;
+
+        struct FirstLevelSlot {
+            Slot slot;
+            Index buckets = NONE;   // the first overflow bucket of the chain
+        } packit;
+
+        private:
+
+        const HashFn hashfn;
+        const ReductionFn reductionfn;
+        std::vector<FirstLevelSlot> slots;
+        std::vector<Bucket> buckets;    // the overflow buckets of all chains
+
+        public:
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of directory slots
+         * @param hashfn the hash function
+        */
+        explicit CompactChained(const size_t& capacity, const HashFn hashfn = HashFn())
+         : hashfn(hashfn), reductionfn(ReductionFn(capacity)), slots(capacity) {};
+
+        CompactChained(CompactChained&&) noexcept = default;
+
+        /**
+         * Inserts a pair (key, value) in the structure.
+         * @param key the key (i.e., the entry in the dataset), different from Sentinel
+         * @param payload the correspondent value
+         * @return false iff the key was already there.
+        */
+        bool insert(const Key& key, const Payload& payload) {
+            return insert_at(reductionfn(hashfn(key)), key, payload);
+        }
+
+        /**
+         * Same as insert(key, payload), for a caller that already knows the directory slot of the key.
+         * @param s the directory slot of the key, in [0, capacity)
+        */
+        bool insert_at(const size_t s, const Key& key, const Payload& payload) {
+            FirstLevelSlot& slot = slots[s];
+            if (slot.slot.key == Sentinel) {
+                slot.slot = {key, payload};
+                return true;
+            }
+            if (slot.slot.key == key)
+                return false;
+            if (slot.buckets == NONE) {
+                slot.buckets = new_bucket(key, payload);
+                return true;
+            }
+            // (indices, since new_bucket may move the buckets)
+            Index b = slot.buckets;
+            while (true) {
+                for (size_t i = 0; i < BucketSize; i++) {
+                    Slot& s = buckets[b].slots[i];
+                    if (s.key == Sentinel) {
+                        s = {key, payload};
+                        return true;
+                    }
+                    if (s.key == key)
+                        return false;
+                }
+                if (buckets[b].next == NONE)
+                    break;
+                b = buckets[b].next;
+            }
+            const Index next = new_bucket(key, payload);
+            buckets[b].next = next;
+            return true;
+        }
+
+        /**
+         * Fills an empty table with sorted keys, allocating the overflow buckets of each chain next to each other.
+         * With a monotone function the keys of a slot are consecutive, and each chain is appended in one go; otherwise a
+         * first pass counts the keys of each slot, so that all the buckets are allocated at once.
+         * @param keys the keys, in increasing order (none of them is Sentinel)
+         * @param payloads the correspondent values
+        */
+        void bulk_load(const std::vector<Key>& keys, const std::vector<Payload>& payloads) {
+            if (!buckets.empty() || keys.size() != payloads.size())
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m buckets.empty() && keys.size()==payloads.size()\n           In --> CompactChained::bulk_load\n");
+            const size_t n = keys.size();
+            std::vector<size_t> homes(n);
+            bool monotone = true;
+            for (size_t k = 0; k < n; k++) {
+                if (unlikely(k > 0 && keys[k] <= keys[k - 1]))
+                    throw std::runtime_error("\033[1;91mAssertion failed\033[0m keys[k-1]<keys[k]\n           In --> CompactChained::bulk_load\n           [k] " + std::to_string(k) + "\n");
+                homes[k] = reductionfn(hashfn(keys[k]));
+                monotone &= (k == 0 || homes[k - 1] <= homes[k]);
+            }
+            size_t total = 0;
+            if (monotone) {
+                // the keys [a, b) share their slot: each chain is appended in one go
+                for (size_t a = 0, b; a < n; a = b) {
+                    for (b = a + 1; b < n && homes[b] == homes[a]; b++);
+                    total += (b - a - 1 + BucketSize - 1) / BucketSize;
+                }
+                reserve_buckets(total);
+                for (size_t a = 0, b; a < n; a = b) {
+                    FirstLevelSlot& slot = slots[homes[a]];
+                    slot.slot = {keys[a], payloads[a]};
+                    for (b = a + 1; b < n && homes[b] == homes[a]; b++) {
+                        const size_t j = b - a - 1;
+                        if (j % BucketSize == 0) {
+                            if (j == 0)
+                                slot.buckets = static_cast<Index>(buckets.size());
+                            else buckets.back().next = static_cast<Index>(buckets.size());
+                            buckets.emplace_back();
+                        }
+                        buckets.back().slots[j % BucketSize] = {keys[b], payloads[b]};
+                    }
+                }
+                return;
+            }
+            // the chain of slot s takes the buckets [slots[s].buckets, slots[s].buckets + ceil((counts[s]-1) / BucketSize))
+            std::vector<Index> counts(slots.size(), 0);
+            for (size_t k = 0; k < n; k++)
+                counts[homes[k]]++;
+            for (size_t s = 0; s < slots.size(); s++) {
+                if (counts[s] > 1) {
+                    slots[s].buckets = static_cast<Index>(std::min<size_t>(total, NONE));
+                    total += (counts[s] - 1 + BucketSize - 1) / BucketSize;
+                }
+            }
+            reserve_buckets(total);
+            buckets.resize(total);
+            for (size_t s = 0; s < slots.size(); s++) {
+                if (counts[s] > 1) {
+                    const size_t last = slots[s].buckets + (counts[s] - 2) / BucketSize;
+                    for (size_t b = slots[s].buckets; b < last; b++)
+                        buckets[b].next = static_cast<Index>(b + 1);
+                }
+                counts[s] = 0;  // (now the pairs already written)
+            }
+            for (size_t k = 0; k < n; k++) {
+                if (k + PREFETCH_DISTANCE < n)
+                    prefetch(&slots[homes[k + PREFETCH_DISTANCE]], 1, 1);
+                FirstLevelSlot& slot = slots[homes[k]];
+                const Index j = counts[homes[k]]++;
+                if (j == 0)
+                    slot.slot = {keys[k], payloads[k]};
+                else buckets[slot.buckets + (j - 1) / BucketSize].slots[(j - 1) % BucketSize] = {keys[k], payloads[k]};
+            }
+        }
+
+        /**
+         * Looks for a single entry in the structure.
+         * @param key the value we are looking for
+         * @return the correspondent payload if the key was found, `std::nullopt` otherwise.
+        */
+        std::optional<Payload> lookup(const Key& key) const {
+            return lookup_at(reductionfn(hashfn(key)), key);
+        }
+
+        /**
+         * Same as lookup(key), for a caller that already knows the directory slot of the key.
+         * @param s the directory slot of the key, in [0, capacity)
+        */
+        std::optional<Payload> lookup_at(const size_t s, const Key& key) const {
+            const FirstLevelSlot& slot = slots[s];
+            if (slot.slot.key == key)
+                return std::make_optional(slot.slot.payload);
+            for (Index b = slot.buckets; b != NONE; b = buckets[b].next) {
+                const Bucket& bucket = buckets[b];
+                for (size_t i = 0; i < BucketSize; i++) {
+                    if (bucket.slots[i].key == key)
+                        return std::make_optional(bucket.slots[i].payload);
+                    if (bucket.slots[i].key == Sentinel)
+                        return std::nullopt;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // the memory reserved by the table (including the unused capacity of the bucket array)
+        size_t byte_size() const {
+            return sizeof(*this) + slots.size() * sizeof(FirstLevelSlot) + buckets.capacity() * sizeof(Bucket);
+        }
+        size_t bucket_count() const {
+            return buckets.size();
+        }
+
+        static constexpr size_t slot_byte_size() {
+            return sizeof(FirstLevelSlot);
+        }
+        static constexpr size_t bucket_byte_size() {
+            return sizeof(Bucket);
+        }
+
+        static std::string name() {
+            return "compact_chained_" + HashFn::name() + "_" + ReductionFn::name() + "_" + std::to_string(BucketSize);
+        }
+
+        private:
+
+        static constexpr size_t PREFETCH_DISTANCE = 16;
+
+        // reserves exactly `total` buckets, for bulk_load
+        void reserve_buckets(const size_t total) {
+            if (unlikely(total >= NONE))
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m buckets.size()<2^32-1\n           In --> CompactChained::bulk_load\n");
+            buckets.reserve(total);
+        }
+
+        // appends a bucket storing (key, payload) as its first pair
+        Index new_bucket(const Key& key, const Payload& payload) {
+            if (unlikely(buckets.size() == NONE))
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m buckets.size()<2^32-1\n           In --> CompactChained::insert\n");
+            // grow by 1.5x rather than 2x: the unused capacity is part of the memory footprint
+            if (buckets.size() == buckets.capacity())
+                buckets.reserve(std::min<size_t>(NONE, buckets.capacity() + buckets.capacity() / 2 + 64));
+            buckets.emplace_back();
+            buckets.back().slots[0] = {key, payload};
+            return static_cast<Index>(buckets.size() - 1);
+        }
+    };
+
+}   // namespace hashtable
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#include "builtins.hpp"
+#include "arena.hpp"
+#include "huge_pages.hpp"
+
+// A lock-free chained table, built and probed by OpenMP threads
+// Each directory slot stores the head of its chain: an insertion prepends a node, publishing it with a CAS on the
+// head, and a node is never modified once published. A lookup only walks the chain from the head it loaded, so it
+// finishes in a bounded number of steps whatever the other threads do (wait-free). Each thread allocates its nodes
+// from its own arena, so the insertions share nothing but the heads of the chains: a hash function sending many keys
+// to the same slots (e.g. a learned one on a skewed dataset) makes the threads retry their CAS more often.
+
+namespace hashtable {
+
+    template <class Key, class Payload, class HashFn, class ReductionFn>
+    class ConcurrentChained {
+
+        struct Node {
+            Key key;
+            Payload payload;
+            Node* next;
+        };
+
+        // the state of a thread (on its own cache line)
+        struct alignas(mem::CACHE_LINE) Local {
+            mem::Arena<Node> arena;
+            size_t retries = 0;     // failed CAS
+        };
+
+        private:
+
+        const HashFn hashfn;
+        const ReductionFn reductionfn;
+        const size_t capacity;
+        std::unique_ptr<std::atomic<Node*>[]> heads;
+        std::vector<Local> locals;      // one per OpenMP thread
+
+        public:
+
+        static constexpr bool CONCURRENT = true;
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of directory slots
+         * @param hashfn the hash function
+         * @param threads the maximum number of threads inserting at the same time (default: the OpenMP one)
+        */
+        explicit ConcurrentChained(const size_t& capacity, const HashFn hashfn = HashFn(), const size_t threads = omp_get_max_threads())
+         : hashfn(hashfn), reductionfn(ReductionFn(capacity)), capacity(std::max<size_t>(1, capacity)),
+           heads(new std::atomic<Node*>[this->capacity]), locals(std::max<size_t>(1, threads)) {};
+
+        ConcurrentChained(ConcurrentChained&&) noexcept = default;
+
+        /**
+         * Inserts a pair (key, value) in the structure, safe to call from many OpenMP threads at once.
+         * @param key the key (i.e., the entry in the dataset)
+         * @param payload the correspondent value
+         * @return false iff the key was already there.
+        */
+        bool insert(const Key& key, const Payload& payload) {
+            const size_t thread = omp_get_thread_num();
+            if (unlikely(thread >= locals.size()))
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m omp_get_thread_num()<threads\n           In --> ConcurrentChained::insert\n           [threads] " + std::to_string(locals.size()) + "\n");
+            Local& local = locals[thread];
+            std::atomic<Node*>& head = heads[slot(key)];
+            Node* first = head.load(std::memory_order_acquire);
+            Node* checked = nullptr;    // the nodes from here on were already compared with the key
+            Node* node = nullptr;
+            while (true) {
+                for (Node* n = first; n != checked; n = n->next) {
+                    // (if another thread inserted the key meanwhile, the node is left unused in the arena)
+                    if (n->key == key)
+                        return false;
+                }
+                checked = first;
+                if (node == nullptr)
+                    node = local.arena.make(Node{key, payload, first});
+                else node->next = first;
+                if (head.compare_exchange_weak(first, node, std::memory_order_release, std::memory_order_acquire))
+                    return true;
+                local.retries++;
+            }
+        }
+
+        /**
+         * Looks for a single entry in the structure (wait-free, also while other threads insert).
+         * @param key the value we are looking for
+         * @return the correspondent payload if the key was found, `std::nullopt` otherwise.
+        */
+        std::optional<Payload> lookup(const Key& key) const {
+            for (const Node* n = heads[slot(key)].load(std::memory_order_acquire); n != nullptr; n = n->next) {
+                if (n->key == key)
+                    return std::make_optional(n->payload);
+            }
+            return std::nullopt;
+        }
+
+        // the failed CAS of all threads (call it when no thread is inserting)
+        size_t cas_retries() const {
+            size_t retries = 0;
+            for (const Local& local : locals)
+                retries += local.retries;
+            return retries;
+        }
+
+        size_t byte_size() const {
+            size_t bytes = sizeof(*this) + capacity * sizeof(std::atomic<Node*>) + locals.size() * sizeof(Local);
+            for (const Local& local : locals)
+                bytes += local.arena.byte_size();
+            return bytes;
+        }
+
+        static std::string name() {
+            return "concurrent_chained_" + HashFn::name() + "_" + ReductionFn::name();
+        }
+
+        private:
+
+        forceinline size_t slot(const Key& key) const {
+            return std::min<size_t>(reductionfn(hashfn(key)), capacity - 1);
+        }
+    };
+
+}   // namespace hashtable
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <immintrin.h>
+#include <omp.h>
+
+#include "builtins.hpp"
+#include "huge_pages.hpp"
+
+// A linear probing table built and probed by OpenMP threads
+// An insertion claims the first empty slot of its probe sequence with a CAS of its key on the key word, then publishes
+// its payload with a release store: the threads looking for other keys can move on as soon as the key is there, while
+// a lookup of the same key waits (acquire) until the payload is published. Slots are never freed, so a key found in a
+// slot stays there. Keys hashed to nearby slots (e.g. by a learned function on a clustered dataset) make the threads
+// compete for the same cache lines, and retry their CAS more often.
+
+namespace hashtable {
+
+    template <class Key, class Payload, class HashFn, class ReductionFn, size_t MaxProbingSteps,
+              Key Sentinel = std::numeric_limits<Key>::max(), Payload Pending = std::numeric_limits<Payload>::max()>
+    class ConcurrentLinear {
+
+        struct Slot {
+            std::atomic<Key> key = Sentinel;
+            std::atomic<Payload> payload = Pending;     // (until the inserting thread publishes it)
+        };
+
+        // the state of a thread (on its own cache line)
+        struct alignas(mem::CACHE_LINE) Local {
+            size_t retries = 0;     // failed CAS
+        };
+
+        private:
+
+        const HashFn hashfn;
+        const ReductionFn reductionfn;
+        const size_t capacity;
+        std::unique_ptr<Slot[]> slots;
+        std::vector<Local> locals;      // one per OpenMP thread
+
+        public:
+
+        static constexpr bool CONCURRENT = true;
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of slots
+         * @param hashfn the hash function
+         * @param threads the maximum number of threads inserting at the same time (default: the OpenMP one)
+        */
+        explicit ConcurrentLinear(const size_t& capacity, const HashFn hashfn = HashFn(), const size_t threads = omp_get_max_threads())
+         : hashfn(hashfn), reductionfn(ReductionFn(capacity)), capacity(std::max<size_t>(1, capacity)),
+           slots(new Slot[this->capacity]), locals(std::max<size_t>(1, threads)) {};
+
+        ConcurrentLinear(ConcurrentLinear&&) noexcept = default;
+
+        /**
+         * Inserts a pair (key, value) in the structure, safe to call from many OpenMP threads at once.
+         * @param key the key (i.e., the entry in the dataset), different from Sentinel
+         * @param payload the correspondent value, different from Pending
+         * @return false iff the key was already there. Throws after MaxProbingSteps slots.
+        */
+        bool insert(const Key& key, const Payload& payload) {
+            const size_t thread = omp_get_thread_num();
+            if (unlikely(thread >= locals.size()))
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m omp_get_thread_num()<threads\n           In --> ConcurrentLinear::insert\n           [threads] " + std::to_string(locals.size()) + "\n");
+            size_t i = home(key);
+            for (size_t step = 0; step < std::min(MaxProbingSteps, capacity); step++) {
+                Slot& slot = slots[i];
+                Key k = slot.key.load(std::memory_order_acquire);
+                while (k == Sentinel) {
+                    if (slot.key.compare_exchange_weak(k, key, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        slot.payload.store(payload, std::memory_order_release);
+                        return true;
+                    }
+                    locals[thread].retries++;
+                }
+                if (k == key)
+                    return false;
+                i = next(i);
+            }
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m steps<MaxProbingSteps\n           In --> ConcurrentLinear::insert\n           [MaxProbingSteps] " + std::to_string(MaxProbingSteps) + "\n");
+        }
+
+        /**
+         * Looks for a single entry in the structure, up to the first empty slot (also while other threads insert).
+         * @param key the value we are looking for
+         * @return the correspondent payload if the key was found, `std::nullopt` otherwise.
+        */
+        std::optional<Payload> lookup(const Key& key) const {
+            size_t i = home(key);
+            for (size_t step = 0; step < capacity; step++) {
+                const Slot& slot = slots[i];
+                const Key k = slot.key.load(std::memory_order_acquire);
+                if (k == Sentinel)
+                    return std::nullopt;
+                if (k == key) {
+                    Payload payload;
+                    while ((payload = slot.payload.load(std::memory_order_acquire)) == Pending)
+                        _mm_pause();
+                    return std::make_optional(payload);
+                }
+                i = next(i);
+            }
+            return std::nullopt;
+        }
+
+        // the number of slots read by lookup(key)
+        size_t probe_length(const Key& key) const {
+            size_t i = home(key), length = 1;
+            for (; length < capacity; length++) {
+                const Key k = slots[i].key.load(std::memory_order_relaxed);
+                if (k == Sentinel || k == key)
+                    break;
+                i = next(i);
+            }
+            return length;
+        }
+
+        // the failed CAS of all threads (call it when no thread is inserting)
+        size_t cas_retries() const {
+            size_t retries = 0;
+            for (const Local& local : locals)
+                retries += local.retries;
+            return retries;
+        }
+
+        size_t byte_size() const {
+            return sizeof(*this) + capacity * sizeof(Slot) + locals.size() * sizeof(Local);
+        }
+
+        static std::string name() {
+            return "concurrent_linear_" + HashFn::name() + "_" + ReductionFn::name();
+        }
+
+        private:
+
+        forceinline size_t home(const Key& key) const {
+            return std::min<size_t>(reductionfn(hashfn(key)), capacity - 1);
+        }
+        forceinline size_t next(const size_t i) const {
+            return (i + 1 == capacity) ? 0 : i + 1;
+        }
+    };
+
+}   // namespace hashtable
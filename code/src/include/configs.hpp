@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <tuple>
 // Functions
 #include <learned_hashing.hpp>
 #include <hashing.hpp>
@@ -8,11 +9,26 @@
 // Tables
 #include <hashtable.hpp>
 #include "rmi_sort.hpp"
+#include "sorted_chained.hpp"
+#include "ordered_linear.hpp"
+#include "concurrent_chained.hpp"
+#include "concurrent_linear.hpp"
+#include "sharded.hpp"
+#include "compact_chained.hpp"
+#include "swiss_table.hpp"
+#include "simd_cuckoo.hpp"
+#include "robin_hood.hpp"
 // Datasets
 #include "datasets.hpp"
 // Coroutines
 #include "coroutines/chained-coro.hpp"
 #include "coroutines/rmi-coro.hpp"
+#include "coroutines/rmi-batch.hpp"
+#include "huge_pages.hpp"
+#include "spline.hpp"
+#include "hybrid_hash.hpp"
+#include "reduction.hpp"
+#include "partitioned.hpp"
 
 // ********************* CONFIGS ********************* //
 
@@ -27,10 +43,31 @@
 // load factors for each table
 constexpr size_t chained_lf[] = {25,50,75,100,125,150,200};
 constexpr size_t linear_lf[] = {25,35,45,55,65,75};
+constexpr size_t robin_hood_lf[] = {25,35,45,55,65,75,85,90};
 constexpr size_t cuckoo_lf[] = {75,80,85,90,95};
+constexpr size_t swiss_lf[] = {25,45,65,75,85,95};
+constexpr size_t simd_cuckoo_lf[] = {75,80,85,90,95,97,99};
+// [SIMD Cuckoo Table] keys stored aside when the kicks fail
+#define CUCKOO_STASH_SIZE 64
 // datasets (when changing them, take a look at the benchmarks.cpp file too!)
 constexpr dataset::ID probe_insert_ds[] = {dataset::ID::GAP_10,dataset::ID::NORMAL,dataset::ID::WIKI,dataset::ID::FB,dataset::ID::OSM};
 
+// ---- Thread Sweep Experiments ---- //
+// load factor of the concurrent chained table (the concurrent linear one uses linear_lf)
+#define THREADS_CHAINED_LF 100
+// [Sharded Table] keys sent to the owner of a shard at once
+#define SHARDED_BATCH_SIZE 256
+// datasets
+constexpr dataset::ID threads_ds[] = {dataset::ID::WIKI,dataset::ID::FB,dataset::ID::OSM};
+
+// ---- Probe Miss Experiments ---- //
+// load factors (of the inserted half of the dataset)
+constexpr size_t probe_miss_lf[] = {25,35,45,55,65,75};
+
+// ---- Bulk Load Experiments ---- //
+// datasets of the classic function (the learned ones are set in benchmarks.cpp)
+constexpr dataset::ID bulk_load_ds[] = {dataset::ID::WIKI,dataset::ID::FB};
+
 // ---- Range Experiments ---- //
 // load factor
 #define RANGE_LOAD_PERC 50
@@ -54,6 +91,8 @@ constexpr dataset::ID collisions_vs_gaps_ds[] = {dataset::ID::UNIFORM,dataset::I
 constexpr size_t build_entries[] = {MAX_DS_SIZE/100, MAX_DS_SIZE/20, MAX_DS_SIZE/10, MAX_DS_SIZE/2, MAX_DS_SIZE};
 // datasets
 constexpr dataset::ID build_time_ds[] = {dataset::ID::UNIFORM};
+// number of shards of the partitioned functions
+#define BUILD_SHARDS 64
 
 // ---- Join Experiments ---- //
 // load factor
@@ -61,6 +100,24 @@ constexpr dataset::ID build_time_ds[] = {dataset::ID::UNIFORM};
 // datasets
 constexpr dataset::ID join_ds[] = {dataset::ID::WIKI,dataset::ID::FB};
 
+// ---- Size Sweep Experiments ---- //
+// dataset sizes, in geometric steps from L1-resident to DRAM-resident tables
+constexpr size_t sweep_sizes[] = {1000,3000,10000,30000,100000,300000,1000000,3000000,10000000,30000000,MAX_DS_SIZE};
+// minimum number of probes for each size (otherwise, small tables would be probed only a few times)
+#define SWEEP_MIN_PROBES 10000000
+// load factor for each table
+#define SWEEP_CHAINED_LF 100
+#define SWEEP_LINEAR_LF 50
+#define SWEEP_CUCKOO_LF 90
+// datasets
+constexpr dataset::ID sweep_ds[] = {dataset::ID::WIKI,dataset::ID::FB};
+
+// ---- Tuning Experiments ---- //
+// the tuner trains the candidate functions on a sample of at most this many keys
+#define TUNER_MAX_SAMPLE 10000000
+// maximum size of the tuned model (in bytes)
+#define TUNER_MEMORY_BUDGET (size_t(1) << 30)
+
 // ---- Everything Else ---- //
 // datasets for remaining experiments
 constexpr dataset::ID collisions_ds[] = {dataset::ID::GAP_10,dataset::ID::UNIFORM,dataset::ID::NORMAL,dataset::ID::WIKI,dataset::ID::FB};
@@ -86,8 +143,12 @@ using RMIHash_100k = learned_hashing::RMIHash<Data, 100000>;
 using RMIHash_1M = learned_hashing::RMIHash<Data, 1000000>;
 using RMIHash_10M = learned_hashing::RMIHash<Data, 10000000>;
 using RMIHash_100M = learned_hashing::RMIHash<Data, 100000000>;
+// candidates of the tuner (consecutive ones must differ by a factor 10 in model count)
+using RMITuningCandidates = std::tuple<RMIHash_10, RMIHash_100, RMIHash_1k, RMIHash_10k, RMIHash_100k, RMIHash_1M, RMIHash_10M, RMIHash_100M>;
 //
 using RMIMonotone = learned_hashing::MonotoneRMIHash<Data, 10000000>;
+using RMIMonotone_10 = learned_hashing::MonotoneRMIHash<Data, 10>;
+using RMIMonotone_1k = learned_hashing::MonotoneRMIHash<Data, 1000>;
 
 // learned_hashing::RadixSplineHash<Data, size_t NumRadixBits, size_t MaxError>
 // notice that MaxError is the parameter controlling the number of models
@@ -113,24 +174,95 @@ using MWHC = exotic_hashing::MWHC<Data>;
 using BitMWHC = exotic_hashing::BitMWHC<Data>;
 using RecSplit = exotic_hashing::RecSplit<Data>;
 
+// runtime-configured learned functions (see the --models option of benchmarks)
+// rmi_coro::RMIHash::set_model_count(models)
+using RMIRuntime = rmi_coro::RMIHash<Data, rmi_coro::RUNTIME_MODELS>;
+// spline::SplineHash::configure(max_error, radix_bits)
+using RadixSplineRuntime = spline::SplineHash<Data, true>;
+using SplineRuntime = spline::SplineHash<Data, false>;
+// spline::SplineHash<Data, bool Radix, size_t MaxError, size_t RadixBits>, with coroutine hashing
+// (the third-party RadixSpline and PGM do not expose their levels: the spline without radix table stands in for PGM)
+// labelled spline_coro_radix_<bits>_<err> and spline_coro_<err>, not after the library functions they stand in for
+using RadixSplineCoro_16 = spline::SplineHash<Data, true, 16, 18>;
+using RadixSplineCoro_128 = spline::SplineHash<Data, true, 128, 18>;
+using RadixSplineCoro_1k = spline::SplineHash<Data, true, 1024, 18>;
+using SplineCoro_16 = spline::SplineHash<Data, false, 16>;
+using SplineCoro_128 = spline::SplineHash<Data, false, 128>;
+using SplineCoro_1k = spline::SplineHash<Data, false, 1024>;
+
+// hybrid::HybridHash<Data, size_t Segments, class Fallback>
+// segments of the RMI root that a linear model fits worse than a classic function use Fallback
+using HybridHash_10 = hybrid::HybridHash<Data, 10, MultPrime64>;
+using HybridHash_100 = hybrid::HybridHash<Data, 100, MultPrime64>;
+using HybridHash_1k = hybrid::HybridHash<Data, 1000, MultPrime64>;
+using HybridHash_10k = hybrid::HybridHash<Data, 10000, MultPrime64>;
+using HybridHash_1M = hybrid::HybridHash<Data, 1000000, MultPrime64>;
+using HybridHash_10M = hybrid::HybridHash<Data, 10000000, MultPrime64>;
+using HybridMurmur_10M = hybrid::HybridHash<Data, 10000000, MURMUR>;
+
+// partitioned::PartitionedFn<Key, class HashFn, size_t Shards>
+// one function per shard of the sorted keys, built in parallel (see PartitionedFn::set_threads)
+using PartitionedRMIHash_100 = partitioned::PartitionedFn<Data, RMIHash_100, BUILD_SHARDS>;
+using PartitionedRadixSplineHash_1k = partitioned::PartitionedFn<Data, RadixSplineHash_1k, BUILD_SHARDS>;
+using PartitionedPGMHash_1k = partitioned::PartitionedFn<Data, PGMHash_1k, BUILD_SHARDS>;
+using PartitionedMWHC = partitioned::PartitionedFn<Data, MWHC, BUILD_SHARDS>;
+using PartitionedRecSplit = partitioned::PartitionedFn<Data, RecSplit, BUILD_SHARDS>;
+
 // ********************* HASH TABLES ********************* //
 using FastModulo = hashing::reduction::FastModulo<Key>;
+// alternative reductions (PowerOfTwo rounds the table size up to a power of two, NoReduction is for learned functions)
+using Fastrange = reduction::Fastrange<Key>;
+using PowerOfTwo = reduction::PowerOfTwo<Key>;
+using NoReduction = reduction::NoReduction<Key>;
 
 template <class HashFn, class ReductionFn = FastModulo>
 using ChainedTable = hashtable::Chained<Key, Payload, 1 /*BucketSize*/, HashFn, ReductionFn>;
+// the same, with 32-bit bucket indices (20-byte directory slots)
+template <class HashFn, class ReductionFn = FastModulo>
+using CompactChainedTable = hashtable::CompactChained<Key, Payload, 1 /*BucketSize*/, HashFn, ReductionFn>;
+// chained table built and probed by many threads (CAS on the chain heads, wait-free lookups)
+template <class HashFn, class ReductionFn = FastModulo>
+using ConcurrentChainedTable = hashtable::ConcurrentChained<Key, Payload, HashFn, ReductionFn>;
+// one chained shard per thread, owning a range of slots: the keys are routed to their owner through SPSC queues
+template <class HashFn, class ReductionFn = FastModulo>
+using ShardedTable = hashtable::Sharded<Key, Payload, HashFn, ReductionFn, SHARDED_BATCH_SIZE>;
+
 
 template <class HashFn, class ReductionFn = FastModulo>
 using LinearTable = hashtable::Probing<Key, Payload, HashFn, ReductionFn, hashtable::LinearProbingFunc, MAX_PROBING_STEPS /*BucketSize = 1 by default*/>;
+// linear probing built and probed by many threads (CAS on the key word, release/acquire on the payload)
+template <class HashFn, class ReductionFn = FastModulo>
+using ConcurrentLinearTable = hashtable::ConcurrentLinear<Key, Payload, HashFn, ReductionFn, MAX_PROBING_STEPS>;
+// linear probing with Robin Hood insertions, early-terminating misses and backward-shift deletions
+template <class HashFn, class ReductionFn = FastModulo>
+using RobinHoodTable = hashtable::RobinHood<Key, Payload, HashFn, ReductionFn, MAX_PROBING_STEPS>;
+// linear probing with runs sorted by key (the hash function must be monotone)
+template <class HashFn>
+using OrderedLinearTable = hashtable::OrderedLinear<Key, Payload, HashFn>;
+
+// open addressing over groups of 16 (SSE2) or 32 (AVX2) slots, filtered by 7-bit tags
+template <class HashFn, class ReductionFn = FastModulo>
+using SwissTable = hashtable::SwissTable<Key, Payload, HashFn, ReductionFn, 16 /*GroupSize*/>;
+template <class HashFn, class ReductionFn = FastModulo>
+using SwissTableWide = hashtable::SwissTable<Key, Payload, HashFn, ReductionFn, 32 /*GroupSize*/>;
 
 template <class HashFn, class ReductionFn = FastModulo>
 using CuckooTable = hashtable::Cuckoo<Key, Payload, 4 /*BucketSize*/, HashFn, XXHash3, ReductionFn, FastModulo, 
     hashtable::BiasedKicking<KICK_BIAS_CHANCE>>;
+// bucketized cuckoo with 8 or 16 slots per bucket, filtered by one-byte fingerprints, and a stash
+template <class HashFn, class ReductionFn = FastModulo>
+using SimdCuckooTable = hashtable::SimdCuckoo<Key, Payload, 16 /*BucketSize*/, HashFn, XXHash3, ReductionFn, CUCKOO_STASH_SIZE>;
+template <class HashFn, class ReductionFn = FastModulo>
+using SimdCuckooTable8 = hashtable::SimdCuckoo<Key, Payload, 8 /*BucketSize*/, HashFn, XXHash3, ReductionFn, CUCKOO_STASH_SIZE>;
 
 // Chained table for range experiments
 template <class HashFn>
 using ChainedRange = hashtable::Chained<Key, Payload, RANGE_BUCKETS /*BucketSize*/, HashFn, FastModulo>;
 template <class HashFn>
 using RMISortRange = hashtable::RMISort<Key, Payload, HashFn>;
+// Order-preserving chained table (HashFn must be monotone)
+template <class HashFn>
+using SortedChainedRange = hashtable::SortedChained<Key, Payload, RANGE_BUCKETS /*BucketSize*/, HashFn>;
 
 
 // ********************* COROUTINES ********************* //
@@ -152,6 +284,32 @@ using RMICoro_100k = rmi_coro::RMIHash<Data, 100000>;
 using RMICoro_1M = rmi_coro::RMIHash<Data, 1000000>;
 using RMICoro_10M = rmi_coro::RMIHash<Data, 10000000>;
 using RMICoro_100M = rmi_coro::RMIHash<Data, 100000000>;
+// reduced precision (8-byte second level models)
+using RMICoroFloat_10k = rmi_coro::RMIHash<Data, 10000, 2, float>;
+using RMICoroFloat_1M = rmi_coro::RMIHash<Data, 1000000, 2, float>;
+using RMICoroFloat_10M = rmi_coro::RMIHash<Data, 10000000, 2, float>;
+using RMICoroFloat_100M = rmi_coro::RMIHash<Data, 100000000, 2, float>;
+using RMICoroFixed_10k = rmi_coro::RMIHash<Data, 10000, 2, rmi_coro::Fixed32>;
+using RMICoroFixed_1M = rmi_coro::RMIHash<Data, 1000000, 2, rmi_coro::Fixed32>;
+using RMICoroFixed_10M = rmi_coro::RMIHash<Data, 10000000, 2, rmi_coro::Fixed32>;
+using RMICoroFixed_100M = rmi_coro::RMIHash<Data, 100000000, 2, rmi_coro::Fixed32>;
+// huge pages (second level models)
+template <size_t Models, mem::Pages Pages>
+using RMICoroHuge = rmi_coro::RMIHash<Data, Models, 2, double, rmi_coro::LinearImpl<Data, double>, rmi_coro::LinearImpl<Data, double>, mem::HugePageAllocator<void, Pages>>;
+using RMICoroTHP_10M = RMICoroHuge<10000000, mem::Pages::TRANSPARENT>;
+using RMICoroTHP_100M = RMICoroHuge<100000000, mem::Pages::TRANSPARENT>;
+using RMICoroHugeTLB_10M = RMICoroHuge<10000000, mem::Pages::EXPLICIT>;
+using RMICoroHugeTLB_100M = RMICoroHuge<100000000, mem::Pages::EXPLICIT>;
+// ... and the table slots, with the same policy as the RMI
+template <class RMIFn>
+using RMIChainedTableCoroHuge = hashtable_coro::ChainedRMICoro<Key, Payload, 1 /*BucketSize*/, RMIFn, FastModulo, std::numeric_limits<Key>::max(), typename RMIFn::AllocatorType>;
+// overflow buckets allocated from an arena, in 2 MB chunks (on huge pages for the Huge table), and freed in bulk
+template <class HashFn>
+using ChainedTableCoroArena = hashtable_coro::Chained<Key, Payload, 1 /*BucketSize*/, HashFn, FastModulo, std::numeric_limits<Key>::max(), std::allocator<void>, true>;
+template <class RMIFn>
+using RMIChainedTableCoroArena = hashtable_coro::ChainedRMICoro<Key, Payload, 1 /*BucketSize*/, RMIFn, FastModulo, std::numeric_limits<Key>::max(), std::allocator<void>, true>;
+template <class RMIFn>
+using RMIChainedTableCoroHugeArena = hashtable_coro::ChainedRMICoro<Key, Payload, 1 /*BucketSize*/, RMIFn, FastModulo, std::numeric_limits<Key>::max(), typename RMIFn::AllocatorType, true>;
 
 template <class RMI>
 using ResultRMIType = typename RMI::template HashResult<Key>;
@@ -10,8 +10,10 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
+#include "../arena.hpp"
 #include "../builtins.hpp"
 
 // TODO - re add
@@ -164,13 +166,17 @@ namespace hashtable_coro
     // ------------------------------------------------------------------- //
 
     template <class Key, class Payload, size_t BucketSize, class HashFn, class ReductionFn,
-              Key Sentinel = std::numeric_limits<Key>::max()>
+              Key Sentinel = std::numeric_limits<Key>::max(), class Allocator = std::allocator<void>,
+              bool BucketArena = false>
     struct Chained
     {
     public:
         using KeyType = Key;
         using PayloadType = Payload;
         using LookupType = LookupResult<Key, Payload>;
+        using AllocatorType = Allocator;
+        // whether the overflow buckets are allocated from an arena (with the huge page policy of Allocator)
+        static constexpr bool BUCKET_ARENA = BucketArena;
 
     private:
         HashFn hashfn;
@@ -215,7 +221,7 @@ namespace hashtable_coro
             Bucket *bucket = slot.buckets;
             if (bucket == nullptr)
             {
-                auto b = new Bucket();
+                auto b = new_bucket();
                 b->slots[0] = {.key = key, .payload = payload};
                 slot.buckets = b;
                 return true;
@@ -246,7 +252,7 @@ namespace hashtable_coro
             }
 
             // Append a new bucket to the chain and add element there
-            auto b = new Bucket();
+            auto b = new_bucket();
             b->slots[0] = {.key = key, .payload = payload};
             bucket->next = b;
             return true;
@@ -259,6 +265,20 @@ namespace hashtable_coro
          * @return a pair <key,value>, where `value` is the payload or nullptr, if `key` was not found.
          */
         LookupType lookup(const Key &key) const
+        {
+            // Using template functor should successfully inline actual hash computation
+            return lookup_at(key, reductionfn(hashfn(key)));
+        }
+
+        /**
+         * Retrieves the associated payload/value for a given key, whose slot was already computed
+         * (e.g., by hashing a whole batch of keys in advance).
+         *
+         * @param key
+         * @param index the slot of the key, that is, reductionfn(hashfn(key))
+         * @return a pair <key,value>, where `value` is the payload or nullptr, if `key` was not found.
+         */
+        forceinline LookupType lookup_at(const Key &key, const size_t index) const
         {
             if (unlikely(key == Sentinel))
             {
@@ -266,8 +286,7 @@ namespace hashtable_coro
                 return LookupType{};
             }
 
-            // Using template functor should successfully inline actual hash computation
-            const FirstLevelSlot &slot = slots[reductionfn(hashfn(key))];
+            const FirstLevelSlot &slot = slots[index];
 
             if (slot.key == key)
             {
@@ -416,6 +435,33 @@ namespace hashtable_coro
             }
         }
 
+        /**
+         * Retrieves the associated payload/value for multiple keys, whose slots were already computed.
+         *
+         * @param begin_keys Begin iterator for the keys collection.
+         * @param end_keys End iterator for the keys collection.
+         * @param begin_indexes Begin iterator for the slots collection (one for each key).
+         * @param begin_results Begin iterator for the result array [this will contain the output]
+         * @return Fills the `begin_results` array with `LookupResult` objects (that is, <key,value> pairs)
+         */
+        template <
+            typename BeginInputIter,
+            typename EndInputIter,
+            typename IndexIter,
+            typename OutputIter>
+        forceinline void batch_multilookup(
+            BeginInputIter begin_keys,
+            EndInputIter end_keys,
+            IndexIter begin_indexes,
+            OutputIter begin_results)
+        {
+            for (auto iter = begin_keys; iter != end_keys; ++iter, ++begin_indexes)
+            {
+                *begin_results = lookup_at(*iter, *begin_indexes);
+                ++begin_results;
+            }
+        }
+
         size_t byte_size() const
         {
             size_t size = sizeof(decltype(*this)) + slots.size() * slot_byte_size();
@@ -437,7 +483,7 @@ namespace hashtable_coro
 
         static forceinline std::string name()
         {
-            return "chained_" + hash_name() + "_" + reducer_name() + "_" + std::to_string(bucket_size());
+            return "chained_" + hash_name() + "_" + reducer_name() + "_" + std::to_string(bucket_size()) + (BucketArena ? "_arena" : "");
         }
 
         static forceinline std::string hash_name()
@@ -466,6 +512,17 @@ namespace hashtable_coro
          */
         void clear()
         {
+            if constexpr (BucketArena)
+            {
+                // the buckets are freed in bulk
+                for (auto &slot : slots)
+                {
+                    slot.key = Sentinel;
+                    slot.buckets = nullptr;
+                }
+                arena.release();
+                return;
+            }
             for (auto &slot : slots)
             {
                 slot.key = Sentinel;
@@ -513,15 +570,25 @@ namespace hashtable_coro
         } packit;
 
         // First bucket is always inline in the slot
-        std::vector<FirstLevelSlot> slots;
+        std::vector<FirstLevelSlot, typename std::allocator_traits<Allocator>::template rebind_alloc<FirstLevelSlot>> slots;
+        // Overflow buckets (only if BucketArena, otherwise they are allocated one by one)
+        mem::Arena<Bucket, mem::pages_of<Allocator>::value> arena;
+
+        forceinline Bucket *new_bucket()
+        {
+            if constexpr (BucketArena)
+                return arena.make();
+            else return new Bucket();
+        }
     };
 
     // ------------------------------------------------------------------- //
 
-    // A variant of the Chained table supporting prefetching of RMI submodels
-    // ** It should be used only with HashFn = some kind of RMIHash function ** //
+    // A variant of the Chained table supporting prefetching of RMI submodels (or of the levels of a spline search)
+    // ** It should be used only with HashFn = some kind of rmi_coro::RMIHash or spline::SplineHash function ** //
     template <class Key, class Payload, size_t BucketSize, class HashFn, class ReductionFn,
-              Key Sentinel = std::numeric_limits<Key>::max()>
+              Key Sentinel = std::numeric_limits<Key>::max(), class Allocator = std::allocator<void>,
+              bool BucketArena = false>
 
     struct ChainedRMICoro
     {
@@ -529,6 +596,9 @@ namespace hashtable_coro
         using KeyType = Key;
         using PayloadType = Payload;
         using LookupType = LookupResult<Key, Payload>;
+        using AllocatorType = Allocator;
+        // whether the overflow buckets are allocated from an arena (with the huge page policy of Allocator)
+        static constexpr bool BUCKET_ARENA = BucketArena;
 
     private:
         HashFn hashfn;
@@ -576,7 +646,7 @@ namespace hashtable_coro
             Bucket *bucket = slot.buckets;
             if (bucket == nullptr)
             {
-                auto b = new Bucket();
+                auto b = new_bucket();
                 b->slots[0] = {.key = key, .payload = payload};
                 slot.buckets = b;
                 return true;
@@ -607,7 +677,7 @@ namespace hashtable_coro
             }
 
             // Append a new bucket to the chain and add element there
-            auto b = new Bucket();
+            auto b = new_bucket();
             b->slots[0] = {.key = key, .payload = payload};
             bucket->next = b;
             return true;
@@ -684,11 +754,38 @@ namespace hashtable_coro
             size_t hash_value; // = std::numeric_limits<size_t>::max();
             
             // ----------------------- embed hash computation! ----------------------- //
-            const auto second_level_index =
-                hashfn.root_model(key, hashfn.second_level_models.size() - 1);
+            if constexpr (requires { hashfn.knot_count(); })
+            {
+                // spline: the radix table entry, each step of the search, then the knot
+                // (tables are never built on an empty dataset)
+                assert(hashfn.knot_count() > 0);
+                size_t first = 0, last = hashfn.knot_count();
+                if constexpr (HashFn::RADIX)
+                {
+                    const std::uint32_t *entry = co_await prefetch_and_schedule_on(hashfn.radix_entry(key), scheduler);
+                    std::tie(first, last) = hashfn.search_range(entry, key);
+                }
+                while (first < last)
+                {
+                    const size_t mid = first + (last - first) / 2;
+                    const Key *mid_key = co_await prefetch_and_schedule_on(hashfn.knot_key_address(mid), scheduler);
+                    if (*mid_key <= key)
+                        first = mid + 1;
+                    else
+                        last = mid;
+                }
+                const size_t i = first > 0 ? first - 1 : 0;
+                const auto *knot = co_await prefetch_and_schedule_on(hashfn.knot_address(i), scheduler);
+                hash_value = hashfn.interpolate(*knot, *hashfn.knot_key_address(i), key);
+            }
+            else
+            {
+                const auto second_level_index =
+                    hashfn.root_model(key, hashfn.second_level_models.size() - 1);
 
-            auto *second_level_model = co_await prefetch_and_schedule_on(hashfn.second_level_models.data() + second_level_index, scheduler);
-            hash_value = (*second_level_model)(key, hashfn.max_output);
+                auto *second_level_model = co_await prefetch_and_schedule_on(hashfn.second_level_models.data() + second_level_index, scheduler);
+                hash_value = hashfn.second_level(*second_level_model, key, second_level_index);
+            }
             // --------------------------------- end --------------------------------- //
 
             // if (hash_value == std::numeric_limits<size_t>::max()) {
@@ -811,7 +908,7 @@ namespace hashtable_coro
 
         static forceinline std::string name()
         {
-            return "chained_coro_" + hash_name() + "_" + reducer_name() + "_" + std::to_string(bucket_size());
+            return "chained_coro_" + hash_name() + "_" + reducer_name() + "_" + std::to_string(bucket_size()) + (BucketArena ? "_arena" : "");
         }
 
         static forceinline std::string hash_name()
@@ -840,6 +937,17 @@ namespace hashtable_coro
          */
         void clear()
         {
+            if constexpr (BucketArena)
+            {
+                // the buckets are freed in bulk
+                for (auto &slot : slots)
+                {
+                    slot.key = Sentinel;
+                    slot.buckets = nullptr;
+                }
+                arena.release();
+                return;
+            }
             for (auto &slot : slots)
             {
                 slot.key = Sentinel;
@@ -887,7 +995,16 @@ namespace hashtable_coro
         } packit;
 
         // First bucket is always inline in the slot
-        std::vector<FirstLevelSlot> slots;
+        std::vector<FirstLevelSlot, typename std::allocator_traits<Allocator>::template rebind_alloc<FirstLevelSlot>> slots;
+        // Overflow buckets (only if BucketArena, otherwise they are allocated one by one)
+        mem::Arena<Bucket, mem::pages_of<Allocator>::value> arena;
+
+        forceinline Bucket *new_bucket()
+        {
+            if constexpr (BucketArena)
+                return arena.make();
+            else return new Bucket();
+        }
     };
 
 } // namespace hashtable_coro
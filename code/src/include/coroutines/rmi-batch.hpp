@@ -0,0 +1,223 @@
+#pragma once
+
+// A batched evaluator for rmi_coro::RMIHash.
+// Second level models are stored as two separate arrays (slopes and intercepts),
+// so that a whole vector of keys can fetch its models with two gathers.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <immintrin.h>
+
+#include "../builtins.hpp"
+
+#include "rmi-coro.hpp"
+
+namespace rmi_coro
+{
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+  constexpr size_t BATCH_LANES = 8;
+#elif defined(__AVX2__)
+  constexpr size_t BATCH_LANES = 4;
+#else
+  constexpr size_t BATCH_LANES = 1;
+#endif
+
+  template <class RMI>
+  class RMIBatch
+  {
+    using Key = typename RMI::KeyType;
+    static_assert(sizeof(Key) == sizeof(std::uint64_t), "RMIBatch only supports 64-bit keys");
+
+    /// the original model, used for the tail of each batch
+    const RMI *rmi;
+
+    /// root model
+    double root_slope = 0, root_intercept = 0;
+    /// second level models are in [0, root_max]
+    double root_max = 0;
+    /// output range is [0, max_output]
+    double max_output = 0;
+
+    /// second level models, in a structure-of-arrays layout
+    std::vector<double> slopes;
+    std::vector<double> intercepts;
+
+  public:
+    /**
+     * Copies the models of an already trained RMI.
+     * @param rmi the trained RMI. It must outlive this object
+     */
+    explicit RMIBatch(const RMI &rmi)
+        : rmi(&rmi), root_slope(rmi.root_model.get_slope()), root_intercept(rmi.root_model.get_intercept()),
+          root_max(rmi.second_level_models.size() - 1), max_output(rmi.max_output)
+    {
+      using SecondLevelModel = typename decltype(rmi.second_level_models)::value_type;
+      static_assert(!SecondLevelModel::anchored, "RMIBatch only supports double precision models");
+      slopes.reserve(rmi.second_level_models.size());
+      intercepts.reserve(rmi.second_level_models.size());
+      for (const auto &model : rmi.second_level_models)
+      {
+        slopes.push_back(model.get_slope());
+        intercepts.push_back(model.get_intercept());
+      }
+    }
+
+    static std::string name()
+    {
+      return RMI::name() + "_batch";
+    }
+
+    /**
+     * @return the instruction set used by hash_batch
+     */
+    static std::string isa()
+    {
+      if constexpr (BATCH_LANES == 8)
+        return "avx512";
+      else if constexpr (BATCH_LANES == 4)
+        return "avx2";
+      return "scalar";
+    }
+
+    size_t byte_size() const
+    {
+      return sizeof(decltype(*this)) + sizeof(double) * (slopes.size() + intercepts.size());
+    }
+
+    /**
+     * Compute hash values for n keys, BATCH_LANES keys at a time.
+     * Keys that do not fill a whole vector fall back to the original RMI.
+     *
+     * @param keys the input array
+     * @param out the output array
+     * @param n the number of keys
+     */
+    void hash_batch(const Key *keys, size_t *out, const size_t n) const
+    {
+      size_t i = 0;
+      if (!slopes.empty())
+        i = hash_vector(keys, out, n);
+      for (; i < n; i++)
+        out[i] = (*rmi)(keys[i]);
+    }
+
+    /**
+     * Compute hash values for multiple keys, in batches.
+     *
+     * @param begin_keys Begin iterator for the keys collection [must be contiguous]
+     * @param end_keys End iterator for the keys collection.
+     * @param begin_results Begin iterator for the result array [this will contain the output]
+     * @return Fills the `begin_results` array with `HashResult` objects (that is, <key,hash> pairs)
+     */
+    template <
+        typename BeginInputIter,
+        typename EndInputIter,
+        typename OutputIter,
+        class Result = size_t>
+    void batch_multihash(
+        BeginInputIter begin_keys,
+        EndInputIter end_keys,
+        OutputIter begin_results) const
+    {
+      using ResultType = typename RMI::template HashResult<Result>;
+      // hash one chunk at a time, to keep the output in cache
+      constexpr size_t CHUNK = 1024;
+      size_t hashes[CHUNK];
+      for (auto iter = begin_keys; iter < end_keys; iter += CHUNK)
+      {
+        const size_t n = std::min<size_t>(CHUNK, std::distance(iter, end_keys));
+        hash_batch(&*iter, hashes, n);
+        for (size_t j = 0; j < n; j++)
+        {
+          *begin_results = ResultType{*(iter + j), hashes[j]};
+          ++begin_results;
+        }
+      }
+    }
+
+  private:
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+    static forceinline __m512d clamp(const __m512d x)
+    {
+      return _mm512_min_pd(_mm512_max_pd(x, _mm512_setzero_pd()), _mm512_set1_pd(1.0));
+    }
+
+    size_t hash_vector(const Key *keys, size_t *out, const size_t n) const
+    {
+      const __m512d r_slope = _mm512_set1_pd(root_slope);
+      const __m512d r_intercept = _mm512_set1_pd(root_intercept);
+      const __m512d r_max = _mm512_set1_pd(root_max);
+      const __m512d o_max = _mm512_set1_pd(max_output);
+      const __m512d half = _mm512_set1_pd(0.5);
+      size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        const __m512d k = _mm512_cvtepu64_pd(_mm512_loadu_si512(keys + i));
+        // root model (separate mul and add, same rounding as the scalar code)
+        const __m512d r = clamp(_mm512_add_pd(_mm512_mul_pd(r_slope, k), r_intercept));
+        const __m512i idx = _mm512_cvttpd_epu64(_mm512_add_pd(_mm512_mul_pd(r_max, r), half));
+        // second level model
+        const __m512d slope = _mm512_i64gather_pd(idx, slopes.data(), sizeof(double));
+        const __m512d intercept = _mm512_i64gather_pd(idx, intercepts.data(), sizeof(double));
+        const __m512d y = clamp(_mm512_add_pd(_mm512_mul_pd(slope, k), intercept));
+        const __m512i res = _mm512_cvttpd_epu64(_mm512_add_pd(_mm512_mul_pd(o_max, y), half));
+        _mm512_storeu_si512(out + i, res);
+      }
+      return i;
+    }
+#elif defined(__AVX2__)
+    static forceinline __m256d clamp(const __m256d x)
+    {
+      return _mm256_min_pd(_mm256_max_pd(x, _mm256_setzero_pd()), _mm256_set1_pd(1.0));
+    }
+
+    // exact (round to nearest) uint64 -> double conversion, AVX2 has no instruction for it
+    static forceinline __m256d to_double(const __m256i x)
+    {
+      const __m256i hi = _mm256_or_si256(_mm256_srli_epi64(x, 32), _mm256_castpd_si256(_mm256_set1_pd(0x1p84)));
+      const __m256i lo = _mm256_blend_epi32(x, _mm256_castpd_si256(_mm256_set1_pd(0x1p52)), 0b10101010);
+      const __m256d f = _mm256_sub_pd(_mm256_castsi256_pd(hi), _mm256_set1_pd(0x1p84 + 0x1p52));
+      return _mm256_add_pd(f, _mm256_castsi256_pd(lo));
+    }
+
+    // truncating double -> uint64 conversion, valid in [0, 2^52)
+    static forceinline __m256i to_uint(const __m256d x)
+    {
+      const __m256d magic = _mm256_set1_pd(0x1p52);
+      const __m256d t = _mm256_add_pd(_mm256_round_pd(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), magic);
+      return _mm256_xor_si256(_mm256_castpd_si256(t), _mm256_castpd_si256(magic));
+    }
+
+    size_t hash_vector(const Key *keys, size_t *out, const size_t n) const
+    {
+      const __m256d r_slope = _mm256_set1_pd(root_slope);
+      const __m256d r_intercept = _mm256_set1_pd(root_intercept);
+      const __m256d r_max = _mm256_set1_pd(root_max);
+      const __m256d o_max = _mm256_set1_pd(max_output);
+      const __m256d half = _mm256_set1_pd(0.5);
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        const __m256d k = to_double(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)));
+        // root model (separate mul and add, same rounding as the scalar code)
+        const __m256d r = clamp(_mm256_add_pd(_mm256_mul_pd(r_slope, k), r_intercept));
+        const __m256i idx = to_uint(_mm256_add_pd(_mm256_mul_pd(r_max, r), half));
+        // second level model
+        const __m256d slope = _mm256_i64gather_pd(slopes.data(), idx, sizeof(double));
+        const __m256d intercept = _mm256_i64gather_pd(intercepts.data(), idx, sizeof(double));
+        const __m256d y = clamp(_mm256_add_pd(_mm256_mul_pd(slope, k), intercept));
+        const __m256i res = to_uint(_mm256_add_pd(_mm256_mul_pd(o_max, y), half));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), res);
+      }
+      return i;
+    }
+#else
+    size_t hash_vector(const Key * /*keys*/, size_t * /*out*/, const size_t /*n*/) const
+    {
+      return 0;
+    }
+#endif
+  };
+
+} // namespace rmi_coro
@@ -11,10 +11,15 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
+#include <omp.h>
 
 #include "../builtins.hpp"
+#include "../huge_pages.hpp"
 
 // ------ coro things ------ //
 #include "cppcoro/coroutine.hpp"
@@ -40,6 +45,10 @@ namespace rmi_coro
   template <class Key, class Precision>
   struct LinearImpl
   {
+    /// models are evaluated directly on the key (see AnchoredLinearImpl)
+    static constexpr bool anchored = false;
+    using Trainer = LinearImpl<Key, Precision>;
+
   protected:
     Precision slope = 0, intercept = 0;
 
@@ -169,15 +178,13 @@ namespace rmi_coro
      * Extrapolates an index for the given key to the range [0, max_value]
      *
      * @param k key value to extrapolate for
-     * @param max_value output indices are \in [0, max_value]. Defaults to
-     * std::numeric_limits<Precision>::max()
+     * @param max_value output indices are \in [0, max_value]
      */
-    forceinline size_t
-    operator()(const Key &k, const Precision &max_value =
-                                 std::numeric_limits<Precision>::max()) const
+    forceinline size_t operator()(const Key &k, const size_t max_value) const
     {
       // +0.5 as a quick&dirty ceil trick
-      const size_t pred = max_value * normalized(k) + 0.5;
+      // (always in double: a float max_value may round above the real one)
+      const size_t pred = static_cast<double>(max_value) * normalized(k) + 0.5;
       assert(pred >= 0);
       assert(pred <= max_value);
       return pred;
@@ -195,28 +202,269 @@ namespace rmi_coro
     forceinline Precision get_intercept() const { return intercept; }
   };
 
+  /// Tag type, selects 32-bit fixed point second level models
+  struct Fixed32
+  {
+  };
+
+  /**
+   * A compact (8 bytes) second level model, for float or Fixed32 precision.
+   *
+   * Evaluating `slope * key + intercept` in single precision is useless with
+   * 64-bit keys (the intercept cancels out most of the product), so the model
+   * is expressed w.r.t. the root model output instead: given u = root(key) in
+   * [0, scale] and the model index i = round(u), it computes
+   *    y = i / scale + offset + slope * (u - i)
+   * where |u - i| <= 0.5, slope = dy/du is ~1/scale on average and offset
+   * is in [-1, 1].
+   * Models are trained in double precision and then converted.
+   *
+   * Fixed32 stores the slope as unsigned Q4.28 and the offset as signed Q1.31
+   * (below one slot of error up to 100M outputs). Slopes above 16 (that is,
+   * models fit on a tiny fraction of their bucket) saturate, and the output is
+   * always clamped to [0, max_value].
+   */
+  template <class Key, class Precision>
+  struct AnchoredLinearImpl
+  {
+    static constexpr bool anchored = true;
+    using Trainer = LinearImpl<Key, double>;
+
+  private:
+    static constexpr bool fixed = std::is_same_v<Precision, Fixed32>;
+    static_assert(fixed || std::is_same_v<Precision, float>,
+                  "AnchoredLinearImpl supports float and Fixed32 precision");
+
+    static constexpr double SLOPE_ONE = 268435456.0;  // Q4.28
+    static constexpr double OFFSET_ONE = 2147483648.0; // Q1.31
+
+    std::conditional_t<fixed, std::uint32_t, float> slope = 0;
+    std::conditional_t<fixed, std::int32_t, float> offset = 0;
+
+  public:
+    AnchoredLinearImpl() = default;
+
+    /**
+     * Converts a model trained in double precision.
+     *
+     * @param model the trained model, y = a * key + b
+     * @param index the index of this model
+     * @param scale root outputs are in [0, scale]
+     * @param center the key for which the root outputs `index`
+     * @param du the slope of the root model, in output units (du/dkey)
+     */
+    AnchoredLinearImpl(const Trainer &model, const size_t index,
+                       const double scale, const double center,
+                       const double du)
+    {
+      double s = 0, y = model.get_intercept();
+      if (du != 0)
+      {
+        y = model.get_slope() * center + model.get_intercept();
+        s = model.get_slope() / du;
+      }
+      // outputs are clamped anyway, this bounds the offset to [-1, 1]
+      y = std::isnan(y) ? 0.0 : std::clamp(y, 0.0, 1.0);
+      s = std::isnan(s) ? 0.0 : std::clamp(s, 0.0, static_cast<double>(std::numeric_limits<float>::max()));
+      const double d = y - index / scale;
+      if constexpr (fixed)
+      {
+        slope = std::min(std::round(s * SLOPE_ONE),
+                         static_cast<double>(std::numeric_limits<std::uint32_t>::max()));
+        offset = std::clamp(std::round(d * OFFSET_ONE),
+                            static_cast<double>(std::numeric_limits<std::int32_t>::min()),
+                            static_cast<double>(std::numeric_limits<std::int32_t>::max()));
+      }
+      else
+      {
+        slope = s;
+        offset = d;
+      }
+    }
+
+    forceinline double get_slope() const
+    {
+      if constexpr (fixed)
+        return slope * (1.0 / SLOPE_ONE);
+      else
+        return slope;
+    }
+
+    forceinline double get_offset() const
+    {
+      if constexpr (fixed)
+        return offset * (1.0 / OFFSET_ONE);
+      else
+        return offset;
+    }
+
+    /**
+     * Extrapolates an index to the range [0, max_value]
+     *
+     * @param u the (unrounded) output of the root model, in [0, scale]
+     * @param index the index of this model
+     * @param inv_scale 1/scale
+     * @param max_value output indices are \in [0, max_value]
+     */
+    forceinline size_t operator()(const double u, const size_t index,
+                                  const double inv_scale,
+                                  const size_t max_value) const
+    {
+      const double t = u - static_cast<double>(index);
+      const double y = std::clamp(
+          index * inv_scale + get_offset() + get_slope() * t, 0.0, 1.0);
+      return static_cast<double>(max_value) * y + 0.5;
+    }
+
+    bool operator==(const AnchoredLinearImpl<Key, Precision> other) const
+    {
+      return slope == other.slope && offset == other.offset;
+    }
+  };
+
+  /// The default second level model for a given precision
+  template <class Key, class Precision>
+  using SecondLevelModelImpl =
+      std::conditional_t<std::is_same_v<Precision, double>, LinearImpl<Key, double>,
+                         AnchoredLinearImpl<Key, Precision>>;
+
+  /// Second level training algorithms (all of them produce the same models)
+  enum class TrainingMode
+  {
+    BUCKETS = 0,    // one vector of datapoints per model
+    SEQUENTIAL = 1, // a single scan of the sample, without intermediate allocations
+    RANGES = 2      // each model is fit on its index range, found by binary search (multi-threaded)
+  };
+
+  /// MaxSecondLevelModelCount for an RMI whose model count is chosen at runtime (see RMIHash::set_model_count)
+  constexpr size_t RUNTIME_MODELS = std::numeric_limits<size_t>::max();
+
   template <class Key, size_t MaxSecondLevelModelCount,
             size_t MinAvgDatapointsPerModel = 2, class Precision = double,
-            class RootModel = LinearImpl<Key, Precision>,
-            class SecondLevelModel = LinearImpl<Key, Precision>>
+            class RootModel = LinearImpl<Key, double>,
+            class SecondLevelModel = SecondLevelModelImpl<Key, Precision>,
+            class Allocator = std::allocator<void>>
   class RMIHash
   {
-    using Datapoint = DatapointImpl<Key, Precision>;
+    /// second level models are trained in this form (and then converted, if anchored)
+    using Trainer = typename SecondLevelModel::Trainer;
+    using TrainingPrecision = std::conditional_t<SecondLevelModel::anchored, double, Precision>;
+    using Datapoint = DatapointImpl<Key, TrainingPrecision>;
     
     // declare friendship with ChainedRMICoro
-    template <class T1, class T2, size_t T3, class T4, class T5, T1 T6>
+    template <class T1, class T2, size_t T3, class T4, class T5, T1 T6, class T7>
     friend struct hashtable_coro::ChainedRMICoro;
+    // declare friendship with the batched evaluator
+    template <class T>
+    friend class RMIBatch;
+
+    /// maximum number of second level models of the RMIs trained from now on (RUNTIME_MODELS only)
+    inline static size_t runtime_model_count = 100;
 
     /// Root model
     RootModel root_model;
 
     /// Second level models
-    std::vector<SecondLevelModel> second_level_models;
+    std::vector<SecondLevelModel, typename std::allocator_traits<Allocator>::template rebind_alloc<SecondLevelModel>> second_level_models;
 
     /// output range is scaled from [0, 1] to [0, max_output] = [0, full_size)
     size_t max_output = 0;
 
+    /// anchored models only: the root output is u = (key - root_min_key) * root_du, in [0, root_scale].
+    /// The integer subtraction is exact, while `slope * key + intercept` loses the low bits of large keys
+    Key root_min_key = 0;
+    double root_du = 0;
+    double root_scale = 1, inv_root_scale = 1;
+
+    forceinline SecondLevelModel make_second_level(const Trainer &model, const size_t index) const
+    {
+      if constexpr (SecondLevelModel::anchored)
+      {
+        const double center = root_du != 0 ? root_min_key + index / root_du : root_min_key;
+        return SecondLevelModel(model, index, root_scale, center, root_du);
+      }
+      else
+        return model;
+    }
+
+    /**
+     * Evaluates the second level model at `index` (that is, the one selected by the root model)
+     */
+    forceinline size_t second_level(const SecondLevelModel &model, const Key &key, const size_t index) const
+    {
+      if constexpr (SecondLevelModel::anchored)
+      {
+        const double u = key > root_min_key ? std::min((key - root_min_key) * root_du, root_scale) : 0.0;
+        return model(u, index, inv_root_scale, max_output);
+      }
+      else
+        return model(key, max_output);
+    }
+
+    /**
+     * Trains the second level models, without scanning the whole sample.
+     *
+     * Since the sample is sorted and the root model is monotone, the models selected by the root
+     * are non-decreasing along the sample. Let b(m) be the first sample with root index >= m:
+     * model m is fit on the range [b(m)-1, b(m+1)-1], which is the exact same range the
+     * sequential algorithm uses. Each b(m+1) is found with an exponential search starting from b(m),
+     * and blocks of models are trained in parallel.
+     */
+    template <class RandomIt>
+    void train_ranges(const RandomIt &sample_begin, const RandomIt &sample_end, const size_t threads)
+    {
+      const size_t sample_size = std::distance(sample_begin, sample_end);
+      const size_t model_cnt = second_level_models.size();
+      const auto root_index = [&](const size_t pos)
+      {
+        return root_model(*(sample_begin + pos), model_cnt - 1);
+      };
+      // first sample in [from, sample_size) with root index >= m (all samples before `from` are < m)
+      const auto first_at_least = [&](const size_t m, const size_t from)
+      {
+        size_t lo = from, hi = from, step = 1;
+        while (hi < sample_size && root_index(hi) < m)
+        {
+          lo = hi + 1;
+          hi = from + step;
+          step <<= 1;
+        }
+        hi = std::min(hi, sample_size);
+        while (lo < hi)
+        {
+          const size_t mid = lo + (hi - lo) / 2;
+          if (root_index(mid) < m)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+        return lo;
+      };
+
+      constexpr size_t BLOCK = 1 << 14;
+      const size_t block_cnt = (model_cnt + BLOCK - 1) / BLOCK;
+      const int n_threads = threads ? threads : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_threads) if (block_cnt > 1)
+      for (size_t block = 0; block < block_cnt; block++)
+      {
+        const size_t model_end = std::min(model_cnt, (block + 1) * BLOCK);
+        size_t begin = first_at_least(block * BLOCK, 0);
+        for (size_t m = block * BLOCK; m < model_end; m++)
+        {
+          const size_t end = first_at_least(m + 1, begin);
+          second_level_models[m] = make_second_level(
+              Trainer(sample_begin, sample_end, std::max<size_t>(begin, 1) - 1,
+                      std::max<size_t>(end, 1) - 1),
+              m);
+          begin = end;
+        }
+      }
+    }
+
   public:
+    using KeyType = Key;
+    using AllocatorType = Allocator;
+
     // A class representing the hash task [coroutines]
     template <typename Scheduler>
     class HashTask;
@@ -261,6 +509,24 @@ namespace rmi_coro
     template <class RandomIt>
     void train(const RandomIt &sample_begin, const RandomIt &sample_end,
                const size_t full_size, bool faster_construction = true)
+    {
+      train(sample_begin, sample_end, full_size,
+            faster_construction ? TrainingMode::RANGES : TrainingMode::BUCKETS);
+    }
+
+    /**
+     * trains rmi on an already sorted sample, with a specific algorithm
+     *
+     * @tparam RandomIt
+     * @param sample_begin
+     * @param sample_end
+     * @param full_size operator() will extrapolate to [0, full_size)
+     * @param mode the training algorithm
+     * @param threads number of threads used by TrainingMode::RANGES (0 = OpenMP default)
+     */
+    template <class RandomIt>
+    void train(const RandomIt &sample_begin, const RandomIt &sample_end,
+               const size_t full_size, const TrainingMode mode, const size_t threads = 0)
     {
       this->max_output = full_size - 1;
       const size_t sample_size = std::distance(sample_begin, sample_end);
@@ -275,10 +541,18 @@ namespace rmi_coro
       // ensure that there is at least MinAvgDatapointsPerModel datapoints per
       // model on average to not waste space/resources
       const auto second_level_model_cnt = std::min(
-          MaxSecondLevelModelCount, sample_size / MinAvgDatapointsPerModel);
+          max_model_count(), sample_size / MinAvgDatapointsPerModel);
       second_level_models = decltype(second_level_models)(second_level_model_cnt);
+      root_scale = std::max<size_t>(second_level_models.size(), 2) - 1;
+      inv_root_scale = 1.0 / root_scale;
+      root_min_key = *sample_begin;
+      root_du = root_model.get_slope() * root_scale;
 
-      if (faster_construction)
+      if (mode == TrainingMode::RANGES)
+      {
+        train_ranges(sample_begin, sample_end, threads);
+      }
+      else if (mode == TrainingMode::SEQUENTIAL)
       {
         // convenience function for training (code deduplication)
         size_t previous_end = 0, finished_end = 0, last_index = 0;
@@ -286,8 +560,10 @@ namespace rmi_coro
         {
           while (last_index < i)
           {
-            second_level_models[last_index++] = SecondLevelModel(
-                sample_begin, sample_end, finished_end, previous_end);
+            second_level_models[last_index] = make_second_level(
+                Trainer(sample_begin, sample_end, finished_end, previous_end),
+                last_index);
+            last_index++;
             finished_end = previous_end;
           }
         };
@@ -346,7 +622,7 @@ namespace rmi_coro
           // Add datapoint at the end of the bucket
           bucket.push_back(Datapoint(
               key,
-              static_cast<Precision>(i) / static_cast<Precision>(sample_size)));
+              static_cast<TrainingPrecision>(i) / static_cast<TrainingPrecision>(sample_size)));
         }
 
         // Edge case: First model does not have enough training data -> add
@@ -373,14 +649,42 @@ namespace rmi_coro
           assert(training_bucket.size() >= 2);
 
           // Train model on training bucket & add it
-          second_level_models[model_idx] = SecondLevelModel(training_bucket);
+          second_level_models[model_idx] =
+              make_second_level(Trainer(training_bucket), model_idx);
         }
       }
     }
 
     static std::string name()
     {
-      return "coro_rmi_hash_" + std::to_string(MaxSecondLevelModelCount);
+      std::string precision = "";
+      if constexpr (std::is_same_v<Precision, float>)
+        precision = "_float";
+      else if constexpr (std::is_same_v<Precision, Fixed32>)
+        precision = "_fixed32";
+      return "coro_rmi_hash_" + std::to_string(max_model_count()) + precision + mem::suffix<Allocator>();
+    }
+
+    /**
+     * Sets the maximum number of second level models of RUNTIME_MODELS RMIs. It affects the RMIs trained
+     * from now on (and name()), while the trained ones keep their models. Everything else (in particular the hash
+     * computation) is the same as with a compile-time count.
+     * @param count the maximum number of second level models (at least 1)
+     */
+    static void set_model_count(const size_t count)
+    {
+      static_assert(MaxSecondLevelModelCount == RUNTIME_MODELS, "the model count is a template argument");
+      if (count == 0)
+        throw std::runtime_error("\033[1;91mAssertion failed\033[0m count>0\n           In --> RMIHash::set_model_count\n");
+      runtime_model_count = count;
+    }
+
+    static size_t max_model_count()
+    {
+      if constexpr (MaxSecondLevelModelCount == RUNTIME_MODELS)
+        return runtime_model_count;
+      else
+        return MaxSecondLevelModelCount;
     }
 
     size_t byte_size() const
@@ -391,6 +695,48 @@ namespace rmi_coro
 
     size_t model_count() const { return 1 + second_level_models.size(); }
 
+    /**
+     * Writes the trained model (a raw dump of the root and second level models)
+     * @param out a binary stream
+     */
+    void save(std::ostream &out) const
+    {
+      static_assert(std::is_trivially_copyable_v<RootModel> && std::is_trivially_copyable_v<SecondLevelModel>);
+      const std::uint64_t layout[] = {sizeof(RootModel), sizeof(SecondLevelModel), second_level_models.size()};
+      out.write(reinterpret_cast<const char *>(layout), sizeof(layout));
+      out.write(reinterpret_cast<const char *>(&root_model), sizeof(root_model));
+      out.write(reinterpret_cast<const char *>(&max_output), sizeof(max_output));
+      out.write(reinterpret_cast<const char *>(&root_min_key), sizeof(root_min_key));
+      const double root_params[] = {root_du, root_scale, inv_root_scale};
+      out.write(reinterpret_cast<const char *>(root_params), sizeof(root_params));
+      out.write(reinterpret_cast<const char *>(second_level_models.data()), sizeof(SecondLevelModel) * second_level_models.size());
+    }
+
+    /**
+     * Reads a model written by save()
+     * @param in a binary stream
+     * @return false if the stream is truncated, or if it stores a different type of model
+     */
+    bool load(std::istream &in)
+    {
+      std::uint64_t layout[3];
+      if (!in.read(reinterpret_cast<char *>(layout), sizeof(layout)) ||
+          layout[0] != sizeof(RootModel) || layout[1] != sizeof(SecondLevelModel) ||
+          layout[2] > max_model_count())
+        return false;
+      double root_params[3];
+      in.read(reinterpret_cast<char *>(&root_model), sizeof(root_model));
+      in.read(reinterpret_cast<char *>(&max_output), sizeof(max_output));
+      in.read(reinterpret_cast<char *>(&root_min_key), sizeof(root_min_key));
+      in.read(reinterpret_cast<char *>(root_params), sizeof(root_params));
+      second_level_models = decltype(second_level_models)(layout[2]);
+      in.read(reinterpret_cast<char *>(second_level_models.data()), sizeof(SecondLevelModel) * layout[2]);
+      root_du = root_params[0];
+      root_scale = root_params[1];
+      inv_root_scale = root_params[2];
+      return static_cast<bool>(in);
+    }
+
     /**
      * Compute hash value for key
      *
@@ -409,7 +755,7 @@ namespace rmi_coro
       assert(second_level_index < second_level_models.size());
       // this is the line we can add coroutines
       const auto result =
-          second_level_models[second_level_index](key, max_output);
+          second_level(second_level_models[second_level_index], key, second_level_index);
 
       assert(result <= max_output);
       return result;
@@ -456,7 +802,7 @@ namespace rmi_coro
 
       auto *second_level_model = co_await prefetch_and_schedule_on(second_level_models.data() + second_level_index, scheduler);
 
-      const auto result = (*second_level_model)(key, max_output);
+      const auto result = second_level(*second_level_model, key, second_level_index);
       assert(result <= max_output);
 
       co_return append(key, result);
@@ -483,7 +829,7 @@ namespace rmi_coro
         OutputIter begin_results,
         std::size_t const n_streams)
     {
-      using FunType = RMIHash<Key, MaxSecondLevelModelCount, MinAvgDatapointsPerModel, Precision, RootModel, SecondLevelModel>;
+      using FunType = RMIHash<Key, MaxSecondLevelModelCount, MinAvgDatapointsPerModel, Precision, RootModel, SecondLevelModel, Allocator>;
       using ResultType = typename FunType::HashResult<Result>;
 
       StaticQueueScheduler<MAX_CORO+1> scheduler{};
@@ -559,7 +905,8 @@ namespace rmi_coro
   template <class Key, size_t MaxSecondLevelModelCount,
             size_t MinAvgDatapointsPerModel, class Precision,
             class RootModel,
-            class SecondLevelModel>
+            class SecondLevelModel,
+            class Allocator>
   template <typename Scheduler>
   class RMIHash<
       Key,
@@ -567,7 +914,8 @@ namespace rmi_coro
       MinAvgDatapointsPerModel,
       Precision,
       RootModel,
-      SecondLevelModel>::HashTask
+      SecondLevelModel,
+      Allocator>::HashTask
   {
   public:
     struct promise_type;
@@ -667,7 +1015,8 @@ namespace rmi_coro
   template <class Key, size_t MaxSecondLevelModelCount,
             size_t MinAvgDatapointsPerModel, class Precision,
             class RootModel,
-            class SecondLevelModel>
+            class SecondLevelModel,
+            class Allocator>
   template <class Result>
   class RMIHash<
       Key,
@@ -675,7 +1024,8 @@ namespace rmi_coro
       MinAvgDatapointsPerModel,
       Precision,
       RootModel,
-      SecondLevelModel>::HashResult
+      SecondLevelModel,
+      Allocator>::HashResult
   {
 
     Key const *key;
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <random>
 #include <stdexcept>
 #include <string>
@@ -400,6 +401,23 @@ class Dataset {
       this->ds = load_ds<Data>(id, dataset_size, dataset_directory);
       this->dataset_size = ds.size();
     }
+    /**
+     * Builds a random sample of another dataset, which preserves its distribution.
+     * Since std::sample is stable, the sample is still sorted and deduplicated.
+     * @param other the full dataset
+     * @param sample_size the number of entries to keep (all of them, if greater than the dataset size)
+     * @param seed the seed of the sampling
+    */
+    Dataset(const Dataset& other, size_t sample_size, size_t seed = 42) : id(other.id) {
+      if (sample_size >= other.dataset_size)
+        this->ds = other.ds;
+      else {
+        std::mt19937_64 rng(seed);
+        this->ds.reserve(sample_size);
+        std::sample(other.ds.begin(), other.ds.end(), std::back_inserter(this->ds), sample_size, rng);
+      }
+      this->dataset_size = ds.size();
+    }
     ID get_id() const {
       return id;
     }
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "configs.hpp"
+#include "simd_hash.hpp"
 
 // generic_function.hpp - a file storing a wrapper for a generic hash function
 namespace _generic_ {
@@ -46,9 +47,12 @@ namespace _generic_ {
         public:
             template <class RandomIt>
             GenericFn(const RandomIt &sample_begin, const RandomIt &sample_end, const size_t max_value) : 
-                    max_value(max_value), reduction(ReductionFn(max_value)) {
+                    max_value(max_value), reduction(ReductionFn(max_value)), batch(fn, reduction, max_value) {
                 init_fn(this->fn, sample_begin, sample_end, max_value);
             }
+            // wraps an already trained (or constructed) function
+            GenericFn(const HashFn& fn, const size_t max_value) :
+                    max_value(max_value), fn(fn), reduction(ReductionFn(max_value)), batch(this->fn, reduction, max_value) {}
             inline Key operator()(const Data &data) const {
                 if constexpr (has_train_method<HashFn>::value) {
                     // is learned
@@ -56,9 +60,33 @@ namespace _generic_ {
                 }
                 return reduction(fn(data));
             }
+            /**
+             * Hashes `n` entries at once, with the same output as calling operator() on each of them.
+             * Classic functions (and their reduction) use the vectorized path when possible,
+             * everything else falls back to the scalar one.
+             * @param data the input array
+             * @param out the output array
+             * @param n the number of entries
+            */
+            inline void hash_batch(const Data* data, Key* out, const size_t n) const {
+                size_t i = batch.hash(data, out, n);
+                for (; i < n; i++)
+                    out[i] = (*this)(data[i]);
+            }
+            // whether hash_batch uses the vectorized path
+            inline bool is_batch_vectorized() const {
+                return batch.is_vectorized();
+            }
+            inline bool is_batch_reduction_vectorized() const {
+                return batch.is_reduction_vectorized();
+            }
             inline static std::string name() {
                 return HashFn::name();
             }
+            // the wrapped function
+            inline const HashFn& function() const {
+                return fn;
+            }
             template <class RandomIt>
             inline static void init_fn(HashFn& fn, const RandomIt &sample_begin, const RandomIt &sample_end, const size_t max_value) {
                 // LEARNED FN
@@ -87,6 +115,7 @@ namespace _generic_ {
             size_t max_value;
             HashFn fn;
             ReductionFn reduction;
+            simd::BatchHasher<HashFn, ReductionFn> batch;
     };
 
 }
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+
+// huge_pages.hpp - an allocator for large, randomly accessed arrays (RMI second level models, table slots).
+// Arrays of at least HUGE_PAGE bytes are mapped on 2 MB pages, so that a random access is much less likely
+// to miss in the dTLB. Everything is (at least) cache-line aligned.
+
+namespace mem {
+    constexpr size_t CACHE_LINE = 64;
+    constexpr size_t HUGE_PAGE = 2 << 20;
+#ifdef MAP_HUGE_2MB
+    constexpr int MAP_HUGE_FLAGS = MAP_HUGETLB | MAP_HUGE_2MB;
+#else
+    constexpr int MAP_HUGE_FLAGS = MAP_HUGETLB | (21 << 26);   // log2(2 MB) << MAP_HUGE_SHIFT
+#endif
+
+    enum class Pages {
+        NONE = 0,           // plain (cache-line aligned) allocation
+        TRANSPARENT = 1,    // 2 MB aligned mmap + madvise(MADV_HUGEPAGE)
+        EXPLICIT = 2        // mmap(MAP_HUGETLB), needs reserved huge pages (vm.nr_hugepages). Falls back to TRANSPARENT
+    };
+    inline std::string name(Pages pages) {
+        switch (pages) {
+            case Pages::TRANSPARENT: return "transparent";
+            case Pages::EXPLICIT: return "explicit";
+            default: return "none";
+        }
+    }
+
+    // set by the first mmap(MAP_HUGETLB) that fails (and falls back to TRANSPARENT)
+    inline std::atomic<bool> hugetlb_failed = false;
+
+    inline size_t round_up(size_t bytes, size_t alignment) {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     * Maps `bytes` (rounded up to a multiple of HUGE_PAGE) of anonymous memory on huge pages.
+     * The result can be released with munmap(p, round_up(bytes, HUGE_PAGE)).
+     * @param bytes the size of the array
+     * @param pages either TRANSPARENT or EXPLICIT
+    */
+    inline void* map_huge(size_t bytes, Pages pages) {
+        const size_t size = round_up(bytes, HUGE_PAGE);
+        if (pages == Pages::EXPLICIT) {
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGE_FLAGS, -1, 0);
+            if (p != MAP_FAILED)
+                return p;
+            if (!hugetlb_failed.exchange(true)) {
+                std::cout << "\033[1;93m [warning]\033[0m mmap(MAP_HUGETLB) failed, falling back to transparent huge pages.\n"
+                          << "           Hint: reserve some with `sysctl vm.nr_hugepages=<count>`\n";
+            }
+        }
+        // over-allocate, so that we can trim the mapping to a 2 MB boundary
+        const size_t padded = size + HUGE_PAGE;
+        char* raw = static_cast<char*>(mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (raw == MAP_FAILED)
+            throw std::bad_alloc();
+        char* aligned = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(raw), HUGE_PAGE));
+        if (aligned > raw)
+            munmap(raw, aligned - raw);
+        if (raw + padded > aligned + size)
+            munmap(aligned + size, raw + padded - (aligned + size));
+        // a hint: THP may be disabled, in that case we simply get 4 KB pages
+        madvise(aligned, size, MADV_HUGEPAGE);
+        return aligned;
+    }
+
+    /**
+     * A std-compatible allocator, mapping large arrays on huge pages.
+     * Smaller arrays (below HUGE_PAGE bytes) are only cache-line aligned.
+    */
+    template <class T, Pages P = Pages::TRANSPARENT>
+    struct HugePageAllocator {
+        using value_type = T;
+        static constexpr Pages pages = P;
+
+        template <class U>
+        struct rebind {
+            using other = HugePageAllocator<U, P>;
+        };
+
+        HugePageAllocator() = default;
+        template <class U>
+        HugePageAllocator(const HugePageAllocator<U, P>&) noexcept {}
+
+        T* allocate(size_t n) {
+            const size_t bytes = n * sizeof(T);
+            if (P != Pages::NONE && bytes >= HUGE_PAGE)
+                return static_cast<T*>(map_huge(bytes, P));
+            constexpr size_t alignment = alignof(T) > CACHE_LINE ? alignof(T) : CACHE_LINE;
+            return static_cast<T*>(::operator new(bytes, std::align_val_t(alignment)));
+        }
+        void deallocate(T* p, size_t n) noexcept {
+            const size_t bytes = n * sizeof(T);
+            if (P != Pages::NONE && bytes >= HUGE_PAGE) {
+                munmap(p, round_up(bytes, HUGE_PAGE));
+                return;
+            }
+            constexpr size_t alignment = alignof(T) > CACHE_LINE ? alignof(T) : CACHE_LINE;
+            ::operator delete(p, std::align_val_t(alignment));
+        }
+
+        template <class U>
+        bool operator==(const HugePageAllocator<U, P>&) const noexcept {
+            return true;
+        }
+    };
+
+    // ----------------- introspection ----------------- //
+    template <class Allocator>
+    struct pages_of {
+        static constexpr Pages value = Pages::NONE;
+    };
+    template <class T, Pages P>
+    struct pages_of<HugePageAllocator<T, P>> {
+        static constexpr Pages value = P;
+    };
+    /**
+     * @return the huge page policy of a structure exposing an `AllocatorType` (NONE otherwise)
+    */
+    template <class T>
+    constexpr Pages pages_policy() {
+        if constexpr (requires { typename T::AllocatorType; })
+            return pages_of<typename T::AllocatorType>::value;
+        else return Pages::NONE;
+    }
+    /**
+     * The huge page policy a structure actually got: EXPLICIT is reported as TRANSPARENT once an mmap(MAP_HUGETLB)
+     * has failed (conservatively, even if the mappings of this structure succeeded).
+     * @return the policy obtained by a structure exposing an `AllocatorType` (NONE otherwise)
+    */
+    template <class T>
+    Pages obtained_pages() {
+        constexpr Pages pages = pages_policy<T>();
+        if (pages == Pages::EXPLICIT && hugetlb_failed.load())
+            return Pages::TRANSPARENT;
+        return pages;
+    }
+    // a suffix for function names
+    template <class Allocator>
+    inline std::string suffix() {
+        switch (pages_of<Allocator>::value) {
+            case Pages::TRANSPARENT: return "_thp";
+            case Pages::EXPLICIT: return "_hugetlb";
+            default: return "";
+        }
+    }
+
+}   // namespace mem
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "builtins.hpp"
+#include "coroutines/rmi-coro.hpp"
+
+// hybrid_hash.hpp - a learned hash function that falls back to a classic one where the CDF is not smooth.
+// The key space is partitioned by the root model of an RMI, and each segment owns the slots of its share of the keys.
+// At training time, each segment is fit with a linear model (as the second level of the RMI); if the model collides
+// more than a random function would, the segment is hashed with Fallback over its own slots instead.
+
+namespace hybrid {
+
+    template <class Key, size_t Segments, class Fallback>
+    class HybridHash {
+        public:
+            // as in the RMI, there are at least this many keys per segment on average
+            static constexpr size_t MIN_KEYS_PER_SEGMENT = 2;
+
+            static std::string name() {
+                return "hybrid_" + std::to_string(Segments) + "_" + Fallback::name();
+            }
+
+            /**
+             * Builds the root model and chooses a learned or a fallback function for each segment.
+             * @param begin the first (sorted) key
+             * @param end past the last key
+             * @param full_size operator() will extrapolate to [0, full_size)
+            */
+            template <class RandomIt>
+            void train(const RandomIt& begin, const RandomIt& end, const size_t full_size) {
+                const size_t n = std::distance(begin, end);
+                max_output = full_size - 1;
+                segments.clear();
+                learned = fallback = 0;
+                fit_error = 0;
+                if (n == 0)
+                    return;
+                root = Model(begin, end, 0, n - 1);
+                segments.resize(std::clamp<size_t>(n / MIN_KEYS_PER_SEGMENT, 1, Segments));
+                const double slots_per_key = double(full_size) / n;
+                double tot_error = 0;
+                // the root is monotone: the keys of each segment are contiguous
+                size_t first = 0;
+                for (size_t s = 0; s < segments.size(); s++) {
+                    size_t last = first;
+                    while (last < n && root(*(begin + last), segments.size() - 1) <= s)
+                        last++;
+                    segments[s] = fit(begin, end, first, last, slots_per_key, tot_error);
+                    first = last;
+                }
+                fit_error = tot_error / n;
+            }
+
+            forceinline size_t operator()(const Key& key) const {
+                if (unlikely(segments.empty()))
+                    return 0;
+                const Segment& segment = segments[root(key, segments.size() - 1)];
+                if (segment.fallback_width == 0)
+                    return segment.model(key, max_output);
+                // fastrange: the high bits of the hash select the slot within the segment
+                return segment.first_slot + static_cast<size_t>((static_cast<unsigned __int128>(fallback_fn(key)) * segment.fallback_width) >> 64);
+            }
+
+            size_t byte_size() const {
+                return sizeof(*this) + segments.size() * sizeof(Segment);
+            }
+            size_t model_count() const {
+                return 1 + segments.size();
+            }
+            // segments (with at least one key) using the linear model
+            size_t learned_segments() const {
+                return learned;
+            }
+            // segments (with at least one key) using Fallback
+            size_t fallback_segments() const {
+                return fallback;
+            }
+            // average distance (in slots) between the linear models and the CDF of the keys
+            double avg_fit_error() const {
+                return fit_error;
+            }
+
+            /**
+             * Writes the trained function
+             * @param out a binary stream
+            */
+            void save(std::ostream& out) const {
+                static_assert(std::is_trivially_copyable_v<Model> && std::is_trivially_copyable_v<Segment>);
+                const std::uint64_t layout[] = {sizeof(Model), sizeof(Segment), segments.size(), learned, fallback};
+                out.write(reinterpret_cast<const char*>(layout), sizeof(layout));
+                out.write(reinterpret_cast<const char*>(&root), sizeof(root));
+                out.write(reinterpret_cast<const char*>(&max_output), sizeof(max_output));
+                out.write(reinterpret_cast<const char*>(&fit_error), sizeof(fit_error));
+                out.write(reinterpret_cast<const char*>(segments.data()), sizeof(Segment) * segments.size());
+            }
+
+            /**
+             * Reads a function written by save()
+             * @param in a binary stream
+             * @return false if the stream is truncated, or if it stores a different type of function
+            */
+            bool load(std::istream& in) {
+                std::uint64_t layout[5];
+                if (!in.read(reinterpret_cast<char*>(layout), sizeof(layout)) ||
+                        layout[0] != sizeof(Model) || layout[1] != sizeof(Segment) || layout[2] > Segments)
+                    return false;
+                in.read(reinterpret_cast<char*>(&root), sizeof(root));
+                in.read(reinterpret_cast<char*>(&max_output), sizeof(max_output));
+                in.read(reinterpret_cast<char*>(&fit_error), sizeof(fit_error));
+                segments.resize(layout[2]);
+                in.read(reinterpret_cast<char*>(segments.data()), sizeof(Segment) * layout[2]);
+                learned = layout[3];
+                fallback = layout[4];
+                return static_cast<bool>(in);
+            }
+
+        private:
+            using Model = rmi_coro::LinearImpl<Key, double>;
+            struct Segment {
+                Model model;                    // unused by fallback segments
+                std::uint64_t first_slot;
+                std::uint64_t fallback_width;   // 0 if the segment is learned
+            };
+
+            Model root;
+            std::vector<Segment> segments;
+            Fallback fallback_fn;
+            size_t max_output = 0;
+            size_t learned = 0, fallback = 0;
+            double fit_error = 0;
+
+            /**
+             * Fits the keys [first, last) with a linear model, and keeps it if it does not collide more than Fallback.
+             * @param slots_per_key the slots owned by the segment are [first, last) * slots_per_key
+             * @param tot_error incremented by the fit error of the keys of the segment
+            */
+            template <class RandomIt>
+            Segment fit(const RandomIt& begin, const RandomIt& end, const size_t first, const size_t last,
+                    const double slots_per_key, double& tot_error) {
+                const size_t first_slot = std::min<size_t>(first * slots_per_key, max_output);
+                const size_t last_slot = std::min<size_t>(last * slots_per_key, max_output + 1);
+                const size_t width = std::max<size_t>(1, last_slot - std::min(first_slot, last_slot));
+                // (keys not in the training set may still end up here)
+                if (first == last)
+                    return {Model(), first_slot, width};
+
+                const Model model(begin, end, first, last - 1);
+                // colliding keys, as in the collisions experiment: the model is monotone, so equal slots are adjacent
+                size_t collisions = 0, run = 0, prev = 0;
+                double error = 0;
+                for (size_t i = first; i < last; i++) {
+                    const size_t slot = model(*(begin + i), max_output);
+                    error += std::abs(double(slot) - i * slots_per_key);
+                    if (i > first && slot == prev) {
+                        run++;
+                        continue;
+                    }
+                    collisions += (run > 1) ? run : 0;
+                    run = 1;
+                    prev = slot;
+                }
+                collisions += (run > 1) ? run : 0;
+                tot_error += error;
+
+                // a key hashed at random collides unless the other keys of the segment miss its slot
+                const size_t keys = last - first;
+                const double expected = keys * (1.0 - std::pow(1.0 - 1.0 / width, double(keys - 1)));
+                if (collisions <= expected) {
+                    learned++;
+                    return {model, first_slot, 0};
+                }
+                fallback++;
+                return {model, first_slot, width};
+            }
+    };
+
+}   // namespace hybrid
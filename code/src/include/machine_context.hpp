@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include <nlohmann/json.hpp>
+
+// machine_context.hpp - a short calibration run, used to normalize results across machines
+// (e.g., the AWS/Azure instances listed in cloud/)
+
+namespace machine {
+    using json = nlohmann::json;
+
+    // ----------------- sysfs utilities ----------------- //
+    inline std::string read_sysfs(const std::string& path) {
+        std::ifstream file(path);
+        std::string value;
+        if (!file.is_open() || !std::getline(file, value))
+            return "";
+        // remove trailing spaces
+        value.erase(value.find_last_not_of(" \n\r\t") + 1);
+        return value;
+    }
+    inline long read_sysfs_number(const std::string& path, long fallback = -1) {
+        std::string value = read_sysfs(path);
+        if (value == "")
+            return fallback;
+        try {
+            return std::stol(value);
+        } catch (std::exception&) {
+            return fallback;
+        }
+    }
+    /**
+     * Parses a sysfs cache size (e.g., "48K", "2048K", "32M") into bytes.
+    */
+    inline size_t parse_size(const std::string& value) {
+        if (value == "")
+            return 0;
+        size_t size = std::stoul(value);
+        switch (value.back()) {
+            case 'K': return size << 10;
+            case 'M': return size << 20;
+            case 'G': return size << 30;
+        }
+        return size;
+    }
+
+    // ----------------- frequencies ----------------- //
+    /**
+     * Measures the TSC frequency, by comparing it with the steady clock for `ms` milliseconds.
+     * @return the TSC frequency in GHz
+    */
+    inline double tsc_ghz(size_t ms = 100) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t tsc_start = __rdtsc();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(ms));
+        uint64_t tsc_end = __rdtsc();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return (tsc_end - tsc_start) / elapsed.count();
+    }
+    /**
+     * Estimates the frequency the core actually runs at under load, using a chain of dependent additions
+     * (one cycle each). Unlike the TSC, this one follows turbo and power saving states.
+     * @return the core frequency in GHz
+    */
+    inline double core_ghz(size_t iterations = 200000000) {
+        uint64_t x = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i += 8) {
+            // 8 dependent adds, the empty asm prevents the compiler from folding them
+            asm volatile("add $1, %0\n\tadd $1, %0\n\tadd $1, %0\n\tadd $1, %0\n\t"
+                         "add $1, %0\n\tadd $1, %0\n\tadd $1, %0\n\tadd $1, %0" : "+r"(x));
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return x / elapsed.count();
+    }
+    /**
+     * The current frequency of each online cpu, as reported by cpufreq.
+     * Falls back to /proc/cpuinfo if cpufreq is not available (e.g., in most VMs).
+    */
+    inline std::vector<double> mhz_per_cpu() {
+        std::vector<double> mhz;
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < cpus; cpu++) {
+            long khz = read_sysfs_number("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_cur_freq");
+            if (khz < 0)
+                break;
+            mhz.push_back(khz / 1000.0);
+        }
+        if (!mhz.empty())
+            return mhz;
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.rfind("cpu MHz", 0) == 0)
+                mhz.push_back(std::stod(line.substr(line.find(':') + 1)));
+        }
+        return mhz;
+    }
+
+    // ----------------- caches ----------------- //
+    /**
+     * Reads the cache hierarchy of cpu0 from sysfs.
+    */
+    inline json caches() {
+        json out = json::array();
+        for (int index = 0; ; index++) {
+            const std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+            const std::string size = read_sysfs(dir + "size");
+            if (size == "")
+                break;
+            json cache;
+            cache["level"] = read_sysfs_number(dir + "level");
+            cache["type"] = read_sysfs(dir + "type");
+            cache["size_bytes"] = parse_size(size);
+            cache["line_bytes"] = read_sysfs_number(dir + "coherency_line_size");
+            cache["ways"] = read_sysfs_number(dir + "ways_of_associativity");
+            cache["shared_cpu_list"] = read_sysfs(dir + "shared_cpu_list");
+            out.push_back(cache);
+        }
+        return out;
+    }
+    /**
+     * @return the size of the last level cache in bytes (or 0 if unknown)
+    */
+    inline size_t llc_bytes() {
+        size_t llc = 0;
+        long llc_level = 0;
+        for (const json& cache : caches()) {
+            long level = cache["level"];
+            if (cache["type"] != "Instruction" && level >= llc_level) {
+                llc_level = level;
+                llc = cache["size_bytes"];
+            }
+        }
+        return llc;
+    }
+
+    // ----------------- memory ----------------- //
+    /**
+     * Measures the DRAM latency with a pointer chasing probe over a single random cycle (Sattolo's algorithm),
+     * one pointer per cache line.
+     * @param bytes the size of the buffer, should be well above the LLC size
+     * @param hops number of dependent loads
+     * @return the average latency of a load, in ns
+    */
+    inline double dram_latency_ns(size_t bytes, size_t hops = 1 << 22) {
+        struct alignas(64) Line {
+            Line* next;
+        };
+        const size_t lines = bytes / sizeof(Line);
+        std::vector<Line> buffer(lines);
+        std::vector<size_t> cycle(lines);
+        std::iota(cycle.begin(), cycle.end(), 0);
+        std::mt19937_64 gen(42);
+        for (size_t i = lines - 1; i > 0; i--) {
+            std::uniform_int_distribution<size_t> dist(0, i - 1);
+            std::swap(cycle[i], cycle[dist(gen)]);
+        }
+        for (size_t i = 0; i < lines; i++)
+            buffer[cycle[i]].next = &buffer[cycle[(i + 1) % lines]];
+        // warm up the TLB and the page tables
+        Line* p = &buffer[0];
+        for (size_t i = 0; i < lines; i++)
+            p = p->next;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < hops; i++)
+            p = p->next;
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        // avoid optimization
+        asm volatile("" : : "r"(p));
+        return elapsed.count() / hops;
+    }
+    /**
+     * Measures the single-thread streaming read bandwidth.
+     * @param bytes the size of the buffer, should be well above the LLC size
+     * @return the best bandwidth out of `reps` runs, in GB/s
+    */
+    inline double stream_bandwidth_gbs(size_t bytes, size_t reps = 3) {
+        std::vector<uint64_t> buffer(bytes / sizeof(uint64_t), 1);
+        double best = 0;
+        for (size_t r = 0; r < reps; r++) {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t sum = std::accumulate(buffer.begin(), buffer.end(), uint64_t(0));
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            asm volatile("" : : "r"(sum));
+            best = std::max(best, bytes / elapsed.count());
+        }
+        return best;
+    }
+
+    // ----------------- everything together ----------------- //
+    /**
+     * Runs the calibration (it takes around a second) and collects the results in a json object.
+    */
+    inline json calibrate() {
+        json out;
+        const double tsc = tsc_ghz();
+        const double core = core_ghz();
+        out["tsc_ghz"] = tsc;
+        out["core_ghz"] = core;
+        // cpufreq values are in kHz (null if cpufreq is not exposed, e.g. in most VMs)
+        const auto mhz = [](long khz) { return khz < 0 ? json(nullptr) : json(khz / 1000.0); };
+        out["base_mhz"] = mhz(read_sysfs_number("/sys/devices/system/cpu/cpu0/cpufreq/base_frequency"));
+        out["turbo_mhz"] = mhz(read_sysfs_number("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq"));
+        long no_turbo = read_sysfs_number("/sys/devices/system/cpu/intel_pstate/no_turbo");
+        long boost = read_sysfs_number("/sys/devices/system/cpu/cpufreq/boost");
+        out["turbo_enabled"] = no_turbo >= 0 ? json(no_turbo == 0) : (boost >= 0 ? json(boost == 1) : json(nullptr));
+        out["governor"] = read_sysfs("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+        out["smt_active"] = read_sysfs_number("/sys/devices/system/cpu/smt/active");
+        out["caches"] = caches();
+        // make sure the probe buffers do not fit in the LLC
+        const size_t llc = llc_bytes();
+        out["llc_bytes"] = llc;
+        const size_t probe_bytes = std::max<size_t>(4 * llc, 256 << 20);
+        const double latency = dram_latency_ns(probe_bytes);
+        out["probe_bytes"] = probe_bytes;
+        out["dram_latency_ns"] = latency;
+        out["dram_latency_cycles"] = latency * core;
+        out["stream_bandwidth_gbs"] = stream_bandwidth_gbs(probe_bytes);
+        return out;
+    }
+    /**
+     * @return the calibration results, computed only once per process
+    */
+    inline const json& get() {
+        static const json context = calibrate();
+        return context;
+    }
+
+}   // namespace machine
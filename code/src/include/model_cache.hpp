@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+
+#include "generic_function.hpp"
+#include "simd_hash.hpp"
+
+// model_cache.hpp - trained hash functions (learned models, perfect hash functions), shared across benchmarks.
+// The same function is often trained on the same keys with the same output range (e.g. once per load factor
+// and table type): the cache trains it once, keeps it in memory (within a byte budget, LRU) and, if the function
+// can be serialized and a directory is set, stores it on disk for the following runs.
+
+namespace model_cache {
+    constexpr std::uint64_t MAGIC = 0x4c444f4d48534148ULL;     // "HASHMODL"
+    constexpr std::uint32_t VERSION = 1;
+    constexpr size_t DEFAULT_BUDGET = size_t(4) << 30;          // 4 GB
+    constexpr size_t FINGERPRINT_SAMPLES = 4096;
+
+    /**
+     * A (cheap) fingerprint of a sorted key range: its size, its bounds and a strided sample of its keys.
+     * @param begin the first key
+     * @param end past the last key
+    */
+    template <class RandomIt>
+    std::uint64_t fingerprint(const RandomIt& begin, const RandomIt& end) {
+        const size_t n = std::distance(begin, end);
+        std::uint64_t h = simd::fmix64(std::uint64_t(n) + 0x9e3779b97f4a7c15ULL);
+        if (n == 0)
+            return h;
+        const size_t stride = std::max<size_t>(1, n / FINGERPRINT_SAMPLES);
+        for (size_t i = 0; i < n; i += stride)
+            h = simd::fmix64(h ^ std::uint64_t(*(begin + i))) + i;
+        return simd::fmix64(h ^ std::uint64_t(*(end - 1)));
+    }
+
+    // functions that can be written to (and read from) a binary stream
+    template <class HashFn>
+    concept Serializable = requires(const HashFn& fn, HashFn& out, std::ostream& os, std::istream& is) {
+        fn.save(os);
+        { out.load(is) } -> std::convertible_to<bool>;
+    };
+
+    template <class HashFn>
+    struct Model {
+        std::shared_ptr<const HashFn> fn;
+        double build_time_s;    // the time spent training the model (the first time)
+        bool cached;            // whether the training was skipped
+    };
+
+    class Cache {
+        public:
+            static Cache& instance() {
+                static Cache cache;
+                return cache;
+            }
+            /**
+             * Enables the on-disk cache.
+             * @param dir an existing directory (empty to disable)
+            */
+            void set_directory(const std::string& dir) {
+                std::lock_guard<std::mutex> lock(mutex);
+                directory = dir;
+            }
+            void set_budget(size_t bytes) {
+                std::lock_guard<std::mutex> lock(mutex);
+                budget = bytes;
+                evict();
+            }
+            void clear() {
+                std::lock_guard<std::mutex> lock(mutex);
+                entries.clear();
+                used = 0;
+            }
+
+            /**
+             * Returns a function trained on [begin, end) with output range [0, max_value),
+             * training it only if it is neither in memory nor on disk.
+             * @param begin the first (sorted) key
+             * @param end past the last key
+             * @param max_value the output range
+            */
+            template <class HashFn, class RandomIt>
+            Model<HashFn> get(const RandomIt& begin, const RandomIt& end, const size_t max_value) {
+                const std::uint64_t fp = fingerprint(begin, end);
+                // the name also covers runtime-configured functions (e.g. RMIRuntime)
+                const std::string key = std::string(typeid(HashFn).name()) + ":" + HashFn::name() + ":" + std::to_string(fp) + ":" + std::to_string(max_value);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto it = entries.find(key);
+                    if (it != entries.end()) {
+                        it->second.last_use = ++clock;
+                        return {std::static_pointer_cast<const HashFn>(it->second.fn), it->second.build_time_s, true};
+                    }
+                }
+                Model<HashFn> model = load<HashFn>(fp, max_value);
+                if (model.fn == nullptr) {
+                    auto fn = std::make_shared<HashFn>();
+                    const auto _start_ = std::chrono::high_resolution_clock::now();
+                    _generic_::GenericFn<HashFn>::init_fn(*fn, begin, end, max_value);
+                    const auto _end_ = std::chrono::high_resolution_clock::now();
+                    model = {fn, std::chrono::duration<double>(_end_ - _start_).count(), false};
+                    save(*fn, fp, max_value, model.build_time_s);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                const size_t bytes = byte_size(*model.fn);
+                if (bytes <= budget) {
+                    auto [it, inserted] = entries.try_emplace(key, Entry{model.fn, bytes, model.build_time_s, ++clock});
+                    if (inserted) {
+                        used += bytes;
+                        evict(key);
+                    }
+                }
+                return model;
+            }
+
+        private:
+            struct Entry {
+                std::shared_ptr<const void> fn;
+                size_t bytes;
+                double build_time_s;
+                std::uint64_t last_use;
+            };
+            std::map<std::string, Entry> entries;
+            std::mutex mutex;
+            std::string directory = "";
+            size_t budget = DEFAULT_BUDGET;
+            size_t used = 0;
+            std::uint64_t clock = 0;
+
+            template <class HashFn>
+            static size_t byte_size(const HashFn& fn) {
+                if constexpr (requires { fn.byte_size(); })
+                    return std::max<size_t>(sizeof(HashFn), fn.byte_size());
+                else return sizeof(HashFn);
+            }
+
+            // drops the least recently used entries (except `keep`) until we are within budget
+            void evict(const std::string& keep = "") {
+                while (used > budget) {
+                    auto lru = entries.end();
+                    for (auto it = entries.begin(); it != entries.end(); it++)
+                        if (it->first != keep && (lru == entries.end() || it->second.last_use < lru->second.last_use))
+                            lru = it;
+                    if (lru == entries.end())
+                        return;
+                    used -= lru->second.bytes;
+                    entries.erase(lru);
+                }
+            }
+
+            template <class HashFn>
+            std::string path(const std::uint64_t fp, const size_t max_value) const {
+                std::ostringstream file;
+                file << directory << "/" << HashFn::name() << "_" << std::hex << fp << "_"
+                     << simd::fmix64(std::hash<std::string>{}(typeid(HashFn).name())) << std::dec << "_" << max_value << ".model";
+                return file.str();
+            }
+
+            /**
+             * Binary format: MAGIC, VERSION, fingerprint, max_value, build time, then the payload written by HashFn::save.
+            */
+            template <class HashFn>
+            void save(const HashFn& fn, const std::uint64_t fp, const size_t max_value, const double build_time_s) const {
+                if constexpr (Serializable<HashFn>) {
+                    if (directory.empty())
+                        return;
+                    const std::string file = path<HashFn>(fp, max_value);
+                    const std::string tmp = file + ".tmp";
+                    {
+                        std::ofstream out(tmp, std::ios::binary);
+                        const std::uint64_t header[] = {MAGIC, VERSION, fp, max_value};
+                        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+                        out.write(reinterpret_cast<const char*>(&build_time_s), sizeof(build_time_s));
+                        fn.save(out);
+                        if (!out) {
+                            std::cout << "\033[1;93m [warning]\033[0m could not write " + file + "\n";
+                            return;
+                        }
+                    }
+                    // never leave a half-written model behind
+                    std::rename(tmp.c_str(), file.c_str());
+                }
+            }
+
+            template <class HashFn>
+            Model<HashFn> load(const std::uint64_t fp, const size_t max_value) const {
+                if constexpr (Serializable<HashFn>) {
+                    if (directory.empty())
+                        return {nullptr, 0, false};
+                    std::ifstream in(path<HashFn>(fp, max_value), std::ios::binary);
+                    std::uint64_t header[4];
+                    double build_time_s;
+                    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != MAGIC ||
+                            header[1] != VERSION || header[2] != fp || header[3] != max_value ||
+                            !in.read(reinterpret_cast<char*>(&build_time_s), sizeof(build_time_s)))
+                        return {nullptr, 0, false};
+                    auto fn = std::make_shared<HashFn>();
+                    if (fn->load(in))
+                        return {fn, build_time_s, true};
+                }
+                return {nullptr, 0, false};
+            }
+    };
+
+    /**
+     * Shortcut for Cache::instance().get<HashFn>(begin, end, max_value)
+    */
+    template <class HashFn, class RandomIt>
+    inline Model<HashFn> get(const RandomIt& begin, const RandomIt& end, const size_t max_value) {
+        return Cache::instance().get<HashFn>(begin, end, max_value);
+    }
+
+}   // namespace model_cache
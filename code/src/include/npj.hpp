@@ -5,9 +5,14 @@
 #include <utility>
 #include <optional>
 #include <tuple>
+#include <atomic>
+#include <stdexcept>
+#include <omp.h>
 
 #include "generic_function.hpp"
+#include "model_cache.hpp"
 #include "sort_indices.hpp"
+#include "bulk_load.hpp"
 #include "thirdparty/perfevent/PerfEvent.hpp"
 
 // A simple wrapper to implement the Non Partitioned Hash Join (NPJ)
@@ -15,20 +20,33 @@
 namespace join {
     // perf
     bool is_first = true;
+
+    // whether the table can be built and probed by many threads at once
+    template <class HashTable>
+    constexpr bool is_concurrent() {
+        if constexpr (requires { HashTable::CONCURRENT; })
+            return HashTable::CONCURRENT;
+        else return false;
+    }
+
     /**
      * Computes a classic inner join between a small table and a big one. 
      * To use our table implementations, we assume the small table does not have duplicates.
+     * Concurrent tables (see is_concurrent) are built and probed by the OpenMP threads, the others by a single one.
+     * With Mode == BULK_LOAD, the small table is sorted (whatever the function) and the hash table is built from it
+     * with bulk::load, by a single thread.
      * @param small_keys keys belonging to the smaller table
      * @param small_payloads payloads of the smaller table
      * @param big_keys keys belonging to the bigger table
      * @param big_payloads payloads of the bigger table
      * @param output_keys the keys resulting from the join
      * @param output_payloads the payloads resulting from the join
-     * @return an optional storing the sort time, build time and the join time. 
-     * If the optional is empty, the insertion in the hash table failed.
+     * @return an optional storing the sort time, build time and the join time, then the training time of the hash
+     * function and whether it was taken from the model cache (see model_cache::get; the build time does not include
+     * the training). If the optional is empty, the insertion in the hash table failed.
     */
-    template <class Key, class Payload, class HashFn, class HashTable, size_t LoadPerc>
-    std::optional<std::tuple<std::chrono::duration<double>,std::chrono::duration<double>,std::chrono::duration<double>>>
+    template <class Key, class Payload, class HashFn, class HashTable, size_t LoadPerc, bulk::BuildMode Mode = bulk::BuildMode::INSERT>
+    std::optional<std::tuple<std::chrono::duration<double>,std::chrono::duration<double>,std::chrono::duration<double>,double,bool>>
         npj_hash(
             std::vector<Key>& small_keys, std::vector<Payload>& small_payloads, /* table 1 */
             std::vector<Key>& big_keys, std::vector<Payload>& big_payloads,     /* table 2 */ 
@@ -48,7 +66,7 @@ namespace join {
         // build the table for the smaller relation
         const size_t capacity = small_keys.size()*100/LoadPerc;
 
-        if (_generic_::GenericFn<HashFn>::needs_sorted_samples()) {
+        if (Mode == bulk::BuildMode::BULK_LOAD || _generic_::GenericFn<HashFn>::needs_sorted_samples()) {
             // sort samples
             if (is_perf)
                 e_sort.startCounters();
@@ -60,20 +78,42 @@ namespace join {
             tot_sort = end-start;
         }
 
+        // (the same function, on the same keys, is shared by the joins of all the tables)
+        const auto model = model_cache::get<HashFn>(small_keys.begin(), small_keys.end(), capacity);
+
         if (is_perf)
             e_insert.startCounters();
         start = std::chrono::high_resolution_clock::now();
-        HashFn fn;
-        _generic_::GenericFn<HashFn>::init_fn(fn,small_keys.begin(),small_keys.end(),capacity);
-        HashTable table(capacity, fn);
+        HashTable table(capacity, *model.fn);
         // insert in the table
-        for (size_t i=0; i<small_keys.size(); i++) {
+        if constexpr (Mode == bulk::BuildMode::BULK_LOAD) {
             try {
-                table.insert(small_keys[i], small_payloads[i]);
+                bulk::load(table, small_keys, small_payloads);
             } catch(std::runtime_error& e) {
-                // if we are here, we failed the insertion
                 return std::nullopt;
             }
+        } else if constexpr (is_concurrent<HashTable>()) {
+            // (an exception cannot leave the parallel region)
+            std::atomic<bool> failed = false;
+            #pragma omp parallel for schedule(static)
+            for (size_t i=0; i<small_keys.size(); i++) {
+                try {
+                    table.insert(small_keys[i], small_payloads[i]);
+                } catch(std::runtime_error& e) {
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+            if (failed.load())
+                return std::nullopt;
+        } else {
+            for (size_t i=0; i<small_keys.size(); i++) {
+                try {
+                    table.insert(small_keys[i], small_payloads[i]);
+                } catch(std::runtime_error& e) {
+                    // if we are here, we failed the insertion
+                    return std::nullopt;
+                }
+            }
         }
         end = std::chrono::high_resolution_clock::now();
         if (is_perf)
@@ -83,12 +123,35 @@ namespace join {
         if (is_perf)
             e_probe.startCounters();
         start = std::chrono::high_resolution_clock::now();
-        for (size_t i=0; i<big_keys.size(); i++) {
-            // look for the element
-            std::optional<Payload> small_payload = table.lookup(big_keys[i]);
-            if (small_payload.has_value()) {
-                output_keys.push_back(big_keys[i]);
-                output_payloads.push_back(std::make_pair(small_payload.value(), big_payloads[i]));
+        if constexpr (is_concurrent<HashTable>()) {
+            // each thread joins a contiguous block of the big table, the outputs are then appended in order
+            std::vector<std::vector<Key>> thread_keys(omp_get_max_threads());
+            std::vector<std::vector<std::pair<Payload,Payload>>> thread_payloads(omp_get_max_threads());
+            #pragma omp parallel
+            {
+                std::vector<Key>& keys = thread_keys[omp_get_thread_num()];
+                std::vector<std::pair<Payload,Payload>>& payloads = thread_payloads[omp_get_thread_num()];
+                #pragma omp for schedule(static)
+                for (size_t i=0; i<big_keys.size(); i++) {
+                    std::optional<Payload> small_payload = table.lookup(big_keys[i]);
+                    if (small_payload.has_value()) {
+                        keys.push_back(big_keys[i]);
+                        payloads.push_back(std::make_pair(small_payload.value(), big_payloads[i]));
+                    }
+                }
+            }
+            for (size_t t=0; t<thread_keys.size(); t++) {
+                output_keys.insert(output_keys.end(), thread_keys[t].begin(), thread_keys[t].end());
+                output_payloads.insert(output_payloads.end(), thread_payloads[t].begin(), thread_payloads[t].end());
+            }
+        } else {
+            for (size_t i=0; i<big_keys.size(); i++) {
+                // look for the element
+                std::optional<Payload> small_payload = table.lookup(big_keys[i]);
+                if (small_payload.has_value()) {
+                    output_keys.push_back(big_keys[i]);
+                    output_payloads.push_back(std::make_pair(small_payload.value(), big_payloads[i]));
+                }
             }
         }
         end = std::chrono::high_resolution_clock::now();
@@ -109,7 +172,7 @@ namespace join {
             e_probe.printReport(perf_out, big_keys.size(), /*printHeader*/ false, /*printData*/ true);
         }
 
-        return std::make_optional(std::make_tuple(tot_sort, tot_build, tot_join));
+        return std::make_optional(std::make_tuple(tot_sort, tot_build, tot_join, model.build_time_s, model.cached));
     }
     
 }   // namespace join  
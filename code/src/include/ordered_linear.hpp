@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "builtins.hpp"
+
+// A linear probing table keeping its runs sorted
+// With a monotone hash function (e.g. MonotoneRMIHash), placing the keys of each run in key order is a valid linear
+// probing layout (the one obtained inserting them in sorted order): a lookup stops at the first larger key (or at an
+// empty slot) instead of scanning to the end of the run. An insertion shifts the larger keys of its run by one slot.
+// Runs do not wrap around: the ones reaching the last slot grow the table past its capacity.
+
+namespace hashtable {
+
+    template <class Key, class Payload, class HashFn, Key Sentinel = std::numeric_limits<Key>::max()>
+    class OrderedLinear {
+
+        struct Slot {
+            Key key = Sentinel;
+            Payload payload;
+        } packit;
+
+        private:
+
+        const HashFn hashfn;            // a monotone function, with outputs in [0, capacity)
+        const size_t capacity;
+        std::vector<Slot> slots;        // (at least capacity)
+        size_t count = 0;
+
+        public:
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of slots, the range of the (already trained) hash function
+         * @param hashfn the monotone hash function
+        */
+        explicit OrderedLinear(const size_t& capacity, const HashFn hashfn)
+         : hashfn(hashfn), capacity(std::max<size_t>(1, capacity)), slots(this->capacity) {};
+
+        OrderedLinear(OrderedLinear&&) noexcept = default;
+
+        /**
+         * Inserts a pair (key, value) in its run, shifting the larger keys of the run by one slot.
+         * @param key the key (i.e., the entry in the dataset), different from Sentinel
+         * @param payload the correspondent value
+         * @return false iff the key was already there.
+        */
+        bool insert(const Key& key, const Payload& payload) {
+            size_t i = home(key);
+            while (slots[i].key < key)      // (Sentinel stops it)
+                i = next(i);
+            if (slots[i].key == key)
+                return false;
+            size_t j = i;
+            while (slots[j].key != Sentinel)
+                j = next(j);
+            std::move_backward(slots.begin() + i, slots.begin() + j, slots.begin() + j + 1);
+            slots[i] = {key, payload};
+            count++;
+            return true;
+        }
+
+        /**
+         * Fills an empty table with sorted keys, placing each one in the first free slot from its home.
+         * @param keys the keys, in increasing order (none of them is Sentinel)
+         * @param payloads the correspondent values
+        */
+        void bulk_load(const std::vector<Key>& keys, const std::vector<Payload>& payloads) {
+            if (count != 0 || keys.size() != payloads.size())
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m count==0 && keys.size()==payloads.size()\n           In --> OrderedLinear::bulk_load\n");
+            size_t free = 0;
+            for (size_t k = 0; k < keys.size(); k++) {
+                if (unlikely(k > 0 && keys[k] <= keys[k - 1]))
+                    throw std::runtime_error("\033[1;91mAssertion failed\033[0m keys[k-1]<keys[k]\n           In --> OrderedLinear::bulk_load\n           [k] " + std::to_string(k) + "\n");
+                const size_t i = std::max(home(keys[k]), free);
+                if (i == slots.size())
+                    grow();
+                slots[i] = {keys[k], payloads[k]};
+                free = i + 1;
+            }
+            count = keys.size();
+        }
+
+        /**
+         * Looks for a single entry in the structure, stopping at the first larger key.
+         * @param key the value we are looking for
+         * @return the correspondent payload if the key was found, `std::nullopt` otherwise.
+        */
+        std::optional<Payload> lookup(const Key& key) const {
+            size_t i = home(key);
+            while (slots[i].key < key) {
+                if (unlikely(++i == slots.size()))
+                    return std::nullopt;
+            }
+            if (slots[i].key == key)
+                return std::make_optional(slots[i].payload);
+            return std::nullopt;
+        }
+
+        // the number of slots read by lookup(key)
+        size_t probe_length(const Key& key) const {
+            const size_t h = home(key);
+            size_t i = h;
+            while (i + 1 < slots.size() && slots[i].key < key)
+                i++;
+            return i - h + 1;
+        }
+        // the number of slots read by an unsuccessful lookup of plain linear probing (up to the end of the run)
+        size_t run_length(const Key& key) const {
+            const size_t h = home(key);
+            size_t i = h;
+            while (i + 1 < slots.size() && slots[i].key != Sentinel)
+                i++;
+            return i - h + 1;
+        }
+
+        size_t byte_size() const {
+            return sizeof(*this) + slots.capacity() * sizeof(Slot);
+        }
+
+        static std::string name() {
+            return "ordered_linear_" + HashFn::name();
+        }
+
+        private:
+
+        forceinline size_t home(const Key& key) const {
+            return std::min<size_t>(hashfn(key), capacity - 1);
+        }
+
+        // (the last run is extended by a new slot)
+        forceinline size_t next(const size_t i) {
+            if (unlikely(i + 1 == slots.size()))
+                grow();
+            return i + 1;
+        }
+
+        // appends an empty slot, reserving a few more (doubling the capacity would double the memory footprint)
+        void grow() {
+            if (slots.size() == slots.capacity())
+                slots.reserve(slots.size() + slots.size() / 64 + 64);
+            slots.emplace_back();
+        }
+    };
+
+}   // namespace hashtable
@@ -16,13 +16,15 @@
 
 #include <nlohmann/json.hpp>
 
+#include "machine_context.hpp"
+
 
 using json = nlohmann::json;
 
 class JsonOutput {
 public:
-    JsonOutput(const std::string& file_directory, const std::string& arg0, std::string filter = "", size_t thread_num = 1) {
-        init(file_directory, arg0, filter, thread_num);
+    JsonOutput(const std::string& file_directory, const std::string& arg0, std::string filter = "", size_t thread_num = 1, bool calibrate = true) {
+        init(file_directory, arg0, filter, thread_num, calibrate);
     }
     JsonOutput() = default;
 
@@ -43,7 +45,7 @@ public:
 
     }
 
-    void init(const std::string& file_directory, const std::string& arg0, std::string filter = "", size_t thread_num = 1) {
+    void init(const std::string& file_directory, const std::string& arg0, std::string filter = "", size_t thread_num = 1, bool calibrate = true) {
         // first, get current time
         std::time_t current_time = std::time(nullptr);
         std::tm* local_time = std::localtime(&current_time);
@@ -61,7 +63,7 @@ public:
             throw std::runtime_error("Error opening JSON file.\n           [Hint!] Check that directory " + file_directory + " exists.\n");
         } else {
             // First, we make the context
-            json_output["context"] = make_context(arg0, local_time, thread_num);
+            json_output["context"] = make_context(arg0, local_time, thread_num, calibrate);
             // Then, we create the benchmark array
             json_output["benchmarks"] = json::array();
         }
@@ -71,7 +73,7 @@ private:
     json json_output;
     std::ofstream output_file;
 
-    json make_context(const std::string& arg0, std::tm* local_time, size_t thread_num) {
+    json make_context(const std::string& arg0, std::tm* local_time, size_t thread_num, bool calibrate) {
         json context;
         // -------------- date -------------- //
         // Get the time zone offset in minutes
@@ -90,7 +92,14 @@ private:
         context["executable"] = arg0;
         context["num_cpus"] = sysconf(_SC_NPROCESSORS_ONLN);
         context["num_threads"] = thread_num;
-        //context["mhz_per_cpu"] = TODO, maybe;
+        context["mhz_per_cpu"] = machine::mhz_per_cpu();
+        // ------------ machine ------------ //
+        // frequencies, caches, memory latency and bandwidth, to normalize results across machines
+        if (calibrate) {
+            std::cout << "Calibrating machine... " << std::flush;
+            context["machine"] = machine::get();
+            std::cout << "done!" << std::endl;
+        }
         return context;
     }
 
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#include "builtins.hpp"
+
+// partitioned.hpp - a learned or perfect hash function built in parallel: the sorted keys are split into
+// Shards contiguous shards, each one with its own function (and its share of the output range), and a small
+// router (the first key of each shard) sends every key to its shard.
+
+namespace partitioned {
+
+    // learned functions are trained on (and output) a range, perfect ones are constructed on the keys
+    template <class HashFn, class RandomIt>
+    concept Learned = requires(HashFn fn, const RandomIt& it, size_t size) { fn.train(it, it, size); };
+
+    template <class Key, class HashFn, size_t Shards>
+    class PartitionedFn {
+        static_assert(Shards > 0);
+        public:
+            using ShardFn = HashFn;
+            static constexpr size_t SHARDS = Shards;
+
+            static std::string name() {
+                return HashFn::name() + "_partitioned_" + std::to_string(Shards);
+            }
+            /**
+             * Sets the threads used by train() from now on.
+             * @param count the number of threads (0 = OpenMP default)
+            */
+            static void set_threads(const size_t count) {
+                threads = count;
+            }
+
+            /**
+             * Builds the router and the function of each shard, in parallel.
+             * @param begin the first (sorted) key
+             * @param end past the last key
+             * @param full_size operator() will extrapolate to [0, full_size)
+            */
+            template <class RandomIt>
+            void train(const RandomIt& begin, const RandomIt& end, const size_t full_size) {
+                train(begin, end, full_size, threads);
+            }
+
+            /**
+             * Same as train(begin, end, full_size), with a given number of threads (0 = OpenMP default)
+            */
+            template <class RandomIt>
+            void train(const RandomIt& begin, const RandomIt& end, const size_t full_size, const size_t n_threads) {
+                const size_t n = std::distance(begin, end);
+                shards.clear();
+                first_keys.clear();
+                if (n == 0)
+                    return;
+                const size_t count = std::min(Shards, n);
+                shards.resize(count);
+                first_keys.resize(count);
+                const double slots_per_key = double(full_size) / n;
+                for (size_t s = 0; s < count; s++) {
+                    const size_t first = n * s / count;
+                    const size_t last = n * (s + 1) / count;
+                    first_keys[s] = *(begin + first);
+                    shards[s].offset = std::min<size_t>(first * slots_per_key, full_size - 1);
+                    const size_t end_slot = (s + 1 == count) ? full_size : std::min<size_t>(last * slots_per_key, full_size);
+                    shards[s].size = std::max<size_t>(1, end_slot - std::min(end_slot, size_t(shards[s].offset)));
+                }
+                const int n_omp = n_threads ? n_threads : omp_get_max_threads();
+                #pragma omp parallel for schedule(dynamic, 1) num_threads(n_omp)
+                for (size_t s = 0; s < count; s++) {
+                    const RandomIt first = begin + n * s / count;
+                    const RandomIt last = begin + n * (s + 1) / count;
+                    if constexpr (Learned<HashFn, RandomIt>)
+                        shards[s].fn.train(first, last, shards[s].size);
+                    else shards[s].fn.construct(first, last);
+                }
+            }
+
+            forceinline size_t operator()(const Key& key) const {
+                if (unlikely(shards.empty()))
+                    return 0;
+                const Shard& shard = shards[route(key)];
+                // learned functions are trained on the shard size, the others are reduced as in GenericFn
+                if constexpr (Learned<HashFn, typename std::vector<Key>::const_iterator>)
+                    return shard.offset + std::min<size_t>(shard.fn(key), shard.size - 1);
+                else return shard.offset + shard.fn(key) % shard.size;
+            }
+
+            size_t byte_size() const {
+                size_t bytes = sizeof(*this) + first_keys.size() * sizeof(Key);
+                for (const Shard& shard : shards) {
+                    if constexpr (requires { shard.fn.byte_size(); })
+                        bytes += sizeof(Shard) - sizeof(HashFn) + shard.fn.byte_size();
+                    else bytes += sizeof(Shard);
+                }
+                return bytes;
+            }
+            size_t shard_count() const {
+                return shards.size();
+            }
+
+        private:
+            struct Shard {
+                HashFn fn;
+                size_t offset;      // first output of the shard
+                size_t size;        // number of outputs of the shard
+            };
+            inline static size_t threads = 0;
+
+            std::vector<Shard> shards;
+            std::vector<Key> first_keys;
+
+            // the last shard whose first key is not greater than `key` (0 if there is none), without branches
+            forceinline size_t route(const Key& key) const {
+                size_t lo = 0, len = first_keys.size();
+                while (len > 1) {
+                    const size_t half = len / 2;
+                    lo = (first_keys[lo + half] <= key) ? lo + half : lo;
+                    len -= half;
+                }
+                return lo;
+            }
+    };
+
+}   // namespace partitioned
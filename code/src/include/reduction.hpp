@@ -0,0 +1,81 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "builtins.hpp"
+
+// reduction.hpp - alternatives to hashing::reduction::FastModulo, to map a 64-bit hash to [0, N).
+// Fastrange and PowerOfTwo avoid the division (the latter only for power-of-two table sizes), NoReduction
+// is for functions whose output is already in [0, N) (i.e., learned ones, trained on the table size).
+
+namespace reduction {
+
+    /**
+     * Lemire's fastrange: (h * N) >> 64, that is, the high bits of the hash select the slot.
+    */
+    template <class T>
+    struct Fastrange {
+        explicit Fastrange(const T& N = 1) : N(N) {}
+        static std::string name() {
+            return "fastrange";
+        }
+        forceinline T operator()(const T& h) const {
+            return static_cast<T>((static_cast<unsigned __int128>(h) * N) >> 64);
+        }
+
+        private:
+            T N;
+    };
+
+    /**
+     * h & (N - 1): the low bits of the hash select the slot. N must be a power of two (see round_capacity).
+    */
+    template <class T>
+    struct PowerOfTwo {
+        explicit PowerOfTwo(const T& N = 1) : mask(N - 1) {
+            if (!std::has_single_bit(static_cast<std::uint64_t>(N)))
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m N is a power of two\n           In --> PowerOfTwo\n           [N] " + std::to_string(N) + "\n");
+        }
+        static std::string name() {
+            return "power_of_two";
+        }
+        // the table size to use instead of `capacity`
+        static size_t round_capacity(const size_t capacity) {
+            return std::bit_ceil(capacity);
+        }
+        forceinline T operator()(const T& h) const {
+            return h & mask;
+        }
+
+        private:
+            T mask;
+    };
+
+    /**
+     * The identity, for hash values that are already in [0, N).
+    */
+    template <class T>
+    struct NoReduction {
+        explicit NoReduction(const T& /*N*/ = 1) {}
+        static std::string name() {
+            return "no_reduction";
+        }
+        forceinline T operator()(const T& h) const {
+            return h;
+        }
+    };
+
+    /**
+     * The table size to use with ReductionFn, given the one we would like to have.
+    */
+    template <class ReductionFn>
+    inline size_t table_size(const size_t capacity) {
+        if constexpr (requires { ReductionFn::round_capacity(capacity); })
+            return ReductionFn::round_capacity(capacity);
+        else return capacity;
+    }
+
+}   // namespace reduction
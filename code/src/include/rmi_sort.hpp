@@ -59,6 +59,24 @@ namespace hashtable {
             return true;
         }
 
+        /**
+         * Fills an empty structure with the whole dataset, already sorted: the slots are written in one sequential pass,
+         * and finalize does not sort them again.
+         * @param keys the keys, in increasing order (exactly `capacity` of them)
+         * @param payloads the correspondent values
+        */
+        void bulk_load(const std::vector<Key>& keys, const std::vector<Payload>& payloads) {
+            if (filled != 0 || keys.size() != capacity || payloads.size() != capacity)
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m filled==0 && keys.size()==capacity && payloads.size()==capacity\n           In --> RMISort::bulk_load\n");
+            for (size_t i=0; i<capacity; i++) {
+                if (i>0 && keys[i] < keys[i-1])
+                    throw std::runtime_error("\033[1;91mAssertion failed\033[0m keys[i-1]<=keys[i]\n           In --> RMISort::bulk_load\n           [i] " + std::to_string(i) + "\n");
+                slots.push_back({keys[i],payloads[i]});
+            }
+            filled = capacity;
+            finalize(/*sorted*/ true);
+        }
+
         /**
          * Looks for a single entry in the structure, by using a bounded binary search.
          * @param key the value we are looking for
@@ -124,12 +142,15 @@ namespace hashtable {
         private:
         /**
          * An utility function which sorts the `slots` array and compute the maximum error of the RMI function.
+         * @param sorted whether the slots were already filled in key order (by bulk_load)
         */
-        void finalize() {
+        void finalize(bool sorted = false) {
             // sort the slots
-            std::sort(slots.begin(), slots.end(), [](Slot lhs, Slot rhs) {
-                return lhs.key < rhs.key;
-            });
+            if (!sorted) {
+                std::sort(slots.begin(), slots.end(), [](Slot lhs, Slot rhs) {
+                    return lhs.key < rhs.key;
+                });
+            }
             // call the function for every key
             for (size_t i=0; i<capacity; i++) {
                 Slot& s = slots[i];
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "builtins.hpp"
+
+// A linear probing table with Robin Hood insertions
+// Each slot stores the distance of its key from its home slot (plus one, 0 means empty). An insertion swaps the
+// carried key with any resident closer to its home, so the keys of a run are sorted by home slot: a lookup can stop
+// at the first resident closer to its home than the key would be, instead of scanning to the end of the run.
+// Deletions shift the following keys of the run back by one slot, so no tombstones are needed.
+
+namespace hashtable {
+
+    template <class Key, class Payload, class HashFn, class ReductionFn, size_t MaxProbingSteps>
+    class RobinHood {
+
+        struct Slot {
+            Key key;
+            Payload payload;
+            std::uint32_t probe = 0;    // displacement + 1, 0 if the slot is empty
+        } packit;
+
+        private:
+
+        const HashFn hashfn;
+        const ReductionFn reductionfn;
+        const size_t capacity;
+        std::vector<Slot> slots;
+
+        public:
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of slots
+         * @param hashfn the hash function
+        */
+        explicit RobinHood(const size_t& capacity, const HashFn hashfn = HashFn())
+         : hashfn(hashfn), reductionfn(ReductionFn(capacity)), capacity(std::max<size_t>(1, capacity)), slots(this->capacity) {};
+
+        RobinHood(RobinHood&&) noexcept = default;
+
+        /**
+         * Inserts a pair (key, value) in the structure.
+         * @param key the key (i.e., the entry in the dataset)
+         * @param payload the correspondent value
+         * @return false iff the key was already there. Throws if a key is displaced by more than MaxProbingSteps.
+        */
+        bool insert(const Key& key, const Payload& payload) {
+            Slot carry = {key, payload, 1};
+            bool original = true;   // (the following keys of the run cannot be equal to the one we swapped out)
+            for (size_t i = home(key);; i = next(i)) {
+                Slot& slot = slots[i];
+                if (slot.probe == 0) {
+                    slot = carry;
+                    return true;
+                }
+                if (original && slot.probe == carry.probe && slot.key == key)
+                    return false;
+                if (slot.probe < carry.probe) {
+                    std::swap(slot, carry);
+                    original = false;
+                }
+                if (unlikely(++carry.probe > std::min(MaxProbingSteps, capacity)))
+                    throw std::runtime_error("\033[1;91mAssertion failed\033[0m displacement<=MaxProbingSteps\n           In --> RobinHood::insert\n           [MaxProbingSteps] " + std::to_string(MaxProbingSteps) + "\n");
+            }
+        }
+
+        /**
+         * Looks for a single entry in the structure, stopping at the first key closer to its home than `key` would be.
+         * @param key the value we are looking for
+         * @return the correspondent payload if the key was found, `std::nullopt` otherwise.
+        */
+        std::optional<Payload> lookup(const Key& key) const {
+            std::uint32_t probe = 1;
+            for (size_t i = home(key);; i = next(i), probe++) {
+                const Slot& slot = slots[i];
+                // (also an empty slot)
+                if (slot.probe < probe)
+                    return std::nullopt;
+                if (slot.probe == probe && slot.key == key)
+                    return std::make_optional(slot.payload);
+            }
+        }
+
+        /**
+         * Removes a key, shifting back the following keys of its run (backward-shift deletion).
+         * @param key the key to remove
+         * @return false if the key was not there.
+        */
+        bool erase(const Key& key) {
+            std::uint32_t probe = 1;
+            size_t i = home(key);
+            for (;; i = next(i), probe++) {
+                if (slots[i].probe < probe)
+                    return false;
+                if (slots[i].probe == probe && slots[i].key == key)
+                    break;
+            }
+            for (size_t j = next(i); slots[j].probe > 1; i = j, j = next(j)) {
+                slots[i] = slots[j];
+                slots[i].probe--;
+            }
+            slots[i].probe = 0;
+            return true;
+        }
+
+        /**
+         * The distribution of the displacements (distance from the home slot) of the keys.
+         * @return the histogram: entry 0 counts the keys in their home slot, entry k > 0 the keys displaced
+         * by [2^(k-1), 2^k) slots.
+        */
+        std::vector<size_t> displacement_histogram() const {
+            std::vector<size_t> histogram;
+            for (const Slot& slot : slots) {
+                if (slot.probe == 0)
+                    continue;
+                const size_t k = std::bit_width(static_cast<size_t>(slot.probe - 1));
+                if (histogram.size() <= k)
+                    histogram.resize(k + 1, 0);
+                histogram[k]++;
+            }
+            return histogram;
+        }
+        double mean_displacement() const {
+            size_t keys = 0, total = 0;
+            for (const Slot& slot : slots) {
+                if (slot.probe == 0)
+                    continue;
+                keys++;
+                total += slot.probe - 1;
+            }
+            return keys ? double(total) / keys : 0.0;
+        }
+        size_t max_displacement() const {
+            std::uint32_t max = 0;
+            for (const Slot& slot : slots)
+                max = std::max(max, slot.probe);
+            return max ? max - 1 : 0;
+        }
+
+        size_t byte_size() const {
+            return sizeof(*this) + slots.size() * sizeof(Slot);
+        }
+
+        static std::string name() {
+            return "robin_hood_" + HashFn::name() + "_" + ReductionFn::name();
+        }
+
+        private:
+
+        forceinline size_t home(const Key& key) const {
+            return std::min<size_t>(reductionfn(hashfn(key)), capacity - 1);
+        }
+        forceinline size_t next(const size_t i) const {
+            return (i + 1 == capacity) ? 0 : i + 1;
+        }
+    };
+
+}   // namespace hashtable
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <thread>
+#include <omp.h>
+
+#include "builtins.hpp"
+#include "huge_pages.hpp"
+#include "reduction.hpp"
+#include "compact_chained.hpp"
+
+// A shared-nothing table: T threads, each one owning a shard
+// Shard t owns the slots [t * capacity / T, (t+1) * capacity / T) of the hash function: with a learned function, which
+// approximates the CDF of the keys, the shards are contiguous key ranges of about the same size, and with a classic one
+// they are random partitions. The batched operations split the keys among the T threads: each thread computes the
+// slot of its keys, sends them (in batches of BatchSize) to the owner of the slot through a single-producer
+// single-consumer queue, and applies the keys it receives to its own shard. No shard is ever accessed by two threads.
+
+namespace hashtable {
+
+    /**
+     * A bounded single-producer single-consumer queue. push and pop move as many items as they can at once,
+     * publishing them with a single release store.
+    */
+    template <class T>
+    class SpscQueue {
+        public:
+            explicit SpscQueue(const size_t size) : ring(std::bit_ceil(std::max<size_t>(2, size))), mask(ring.size() - 1) {}
+
+            // @return how many of the n items were pushed
+            size_t push(const T* items, const size_t n) {
+                const size_t t = tail.load(std::memory_order_relaxed);
+                const size_t k = std::min(n, ring.size() - (t - head.load(std::memory_order_acquire)));
+                for (size_t i = 0; i < k; i++)
+                    ring[(t + i) & mask] = items[i];
+                tail.store(t + k, std::memory_order_release);
+                return k;
+            }
+            // @return how many items (at most n) were popped
+            size_t pop(T* items, const size_t n) {
+                const size_t h = head.load(std::memory_order_relaxed);
+                const size_t k = std::min(n, tail.load(std::memory_order_acquire) - h);
+                for (size_t i = 0; i < k; i++)
+                    items[i] = ring[(h + i) & mask];
+                head.store(h + k, std::memory_order_release);
+                return k;
+            }
+
+        private:
+            std::vector<T> ring;
+            const size_t mask;
+            alignas(mem::CACHE_LINE) std::atomic<size_t> head = 0;     // (written by the consumer)
+            alignas(mem::CACHE_LINE) std::atomic<size_t> tail = 0;     // (written by the producer)
+    };
+
+    template <class Key, class Payload, class HashFn, class ReductionFn, size_t BatchSize>
+    class Sharded {
+
+        // the shards get the slot of each key from the router (insert_at, lookup_at), they never hash it
+        struct Routed {
+            static std::string name() {
+                return "routed";
+            }
+            size_t operator()(const Key&) const {
+                return 0;
+            }
+        };
+        using Shard = CompactChained<Key, Payload, 1 /*BucketSize*/, Routed, reduction::NoReduction<size_t>>;
+
+        // a key sent to the owner of its slot
+        struct Item {
+            Key key;
+            size_t index;   // in the batch
+            size_t slot;    // in the shard
+        };
+
+        private:
+
+        const HashFn hashfn;
+        const ReductionFn reductionfn;
+        const size_t capacity;
+        const size_t threads;
+        std::vector<size_t> begins;     // the first slot of each shard (and capacity)
+        std::vector<Shard> shards;
+        std::vector<size_t> counts;     // the keys of shard t in counts[t * PADDING] (one cache line per thread)
+        std::vector<std::unique_ptr<SpscQueue<Item>>> queues;   // queues[from * threads + to]
+
+        public:
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of slots (of all shards)
+         * @param hashfn the hash function, choosing both the shard and the slot
+         * @param threads the number of shards, and of threads running the batched operations (default: the OpenMP one)
+        */
+        explicit Sharded(const size_t& capacity, const HashFn hashfn = HashFn(), const size_t threads = omp_get_max_threads())
+         : hashfn(hashfn), reductionfn(ReductionFn(capacity)), capacity(std::max<size_t>(1, capacity)), threads(std::clamp<size_t>(threads, 1, this->capacity)) {
+            for (size_t t = 0; t <= this->threads; t++)
+                begins.push_back((t * this->capacity + this->threads - 1) / this->threads);
+            shards.reserve(this->threads);
+            for (size_t t = 0; t < this->threads; t++)
+                shards.emplace_back(begins[t + 1] - begins[t]);
+            counts.assign(this->threads * PADDING, 0);
+            for (size_t q = 0; q < this->threads * this->threads; q++)
+                queues.push_back(std::make_unique<SpscQueue<Item>>(4 * BatchSize));
+        };
+
+        Sharded(Sharded&&) noexcept = default;
+
+        /**
+         * Inserts the pairs (keys[i], payloads[i]) with `threads` threads, each one inserting in its own shard.
+         * @param keys the keys
+         * @param payloads the correspondent values
+         * @return the number of inserted keys (the others were already there).
+        */
+        size_t insert_batch(const std::vector<Key>& keys, const std::vector<Payload>& payloads) {
+            const size_t before = size();
+            route(keys, [&](const size_t t, const Item& item) {
+                counts[t * PADDING] += shards[t].insert_at(item.slot, item.key, payloads[item.index]);
+            });
+            return size() - before;
+        }
+
+        /**
+         * Looks for the keys with `threads` threads, each one probing its own shard.
+         * @param keys the values we are looking for
+         * @param out the correspondent payloads (`std::nullopt` for the keys not found)
+        */
+        void lookup_batch(const std::vector<Key>& keys, std::vector<std::optional<Payload>>& out) const {
+            out.assign(keys.size(), std::nullopt);
+            route(keys, [&](const size_t t, const Item& item) {
+                out[item.index] = shards[t].lookup_at(item.slot, item.key);
+            });
+        }
+
+        // the single key operations (by the calling thread)
+        bool insert(const Key& key, const Payload& payload) {
+            const size_t s = slot(key), t = shard_of(s);
+            const bool inserted = shards[t].insert_at(s - begins[t], key, payload);
+            counts[t * PADDING] += inserted;
+            return inserted;
+        }
+        std::optional<Payload> lookup(const Key& key) const {
+            const size_t s = slot(key), t = shard_of(s);
+            return shards[t].lookup_at(s - begins[t], key);
+        }
+
+        // the keys of each shard (how evenly the function split them)
+        std::vector<size_t> shard_sizes() const {
+            std::vector<size_t> sizes;
+            for (size_t t = 0; t < threads; t++)
+                sizes.push_back(counts[t * PADDING]);
+            return sizes;
+        }
+        size_t size() const {
+            size_t count = 0;
+            for (size_t t = 0; t < threads; t++)
+                count += counts[t * PADDING];
+            return count;
+        }
+
+        size_t byte_size() const {
+            size_t bytes = sizeof(*this) + (begins.size() + counts.size()) * sizeof(size_t) + queues.size() * (sizeof(SpscQueue<Item>) + 4 * BatchSize * sizeof(Item));
+            for (const Shard& shard : shards)
+                bytes += shard.byte_size();
+            return bytes;
+        }
+
+        static std::string name() {
+            return "sharded_" + HashFn::name() + "_" + ReductionFn::name() + "_" + std::to_string(BatchSize);
+        }
+
+        private:
+
+        static constexpr size_t PADDING = mem::CACHE_LINE / sizeof(size_t);
+
+        forceinline size_t slot(const Key& key) const {
+            return std::min<size_t>(reductionfn(hashfn(key)), capacity - 1);
+        }
+        forceinline size_t shard_of(const size_t s) const {
+            return static_cast<size_t>(static_cast<unsigned __int128>(s) * threads / capacity);
+        }
+
+        /**
+         * Runs apply(t, item) for each key, in the thread owning its shard t.
+         * Thread t routes the keys [n * t / threads, n * (t+1) / threads), and drains its incoming queues
+         * whenever it sends a batch (and while it waits for room in a full queue), until all threads are done.
+         * An exception of apply (e.g. a full shard) cannot leave the parallel region: it is stored, the threads keep
+         * routing and draining (so no producer is left waiting on a full queue), and it is thrown again at the end.
+        */
+        template <class Apply>
+        void route(const std::vector<Key>& keys, const Apply& apply) const {
+            const size_t n = keys.size();
+            std::atomic<size_t> done = 0;
+            std::atomic<bool> missing_threads = false;
+            std::atomic<bool> failed = false;
+            std::string fail_what;
+            #pragma omp parallel num_threads(threads)
+            {
+                const size_t me = omp_get_thread_num();
+                // (a shard without its thread would never be drained)
+                if (static_cast<size_t>(omp_get_num_threads()) != threads)
+                    missing_threads.store(true);
+                else {
+                    std::vector<std::vector<Item>> outgoing(threads);
+                    for (std::vector<Item>& batch : outgoing)
+                        batch.reserve(BatchSize);
+                    std::vector<Item> incoming(BatchSize);
+
+                    const auto safe_apply = [&](const Item& item) {
+                        try {
+                            apply(me, item);
+                        } catch(std::runtime_error& e) {
+                            #pragma omp critical
+                            {
+                                if (!failed.load(std::memory_order_relaxed))
+                                    fail_what = e.what();
+                                failed.store(true, std::memory_order_relaxed);
+                            }
+                        }
+                    };
+
+                    const auto drain = [&]() {
+                        for (size_t from = 0; from < threads; from++) {
+                            SpscQueue<Item>& queue = *queues[from * threads + me];
+                            for (size_t k; (k = queue.pop(incoming.data(), BatchSize)) > 0; ) {
+                                for (size_t i = 0; i < k; i++)
+                                    safe_apply(incoming[i]);
+                            }
+                        }
+                    };
+                    const auto send = [&](const size_t to) {
+                        std::vector<Item>& batch = outgoing[to];
+                        SpscQueue<Item>& queue = *queues[me * threads + to];
+                        for (size_t sent = queue.push(batch.data(), batch.size()); sent < batch.size(); ) {
+                            drain();
+                            std::this_thread::yield();    // (when there are more threads than cores)
+                            sent += queue.push(batch.data() + sent, batch.size() - sent);
+                        }
+                        batch.clear();
+                        drain();
+                    };
+
+                    for (size_t i = n * me / threads; i < n * (me + 1) / threads; i++) {
+                        const size_t s = slot(keys[i]);
+                        const size_t to = shard_of(s);
+                        const Item item = {keys[i], i, s - begins[to]};
+                        if (to == me)
+                            safe_apply(item);
+                        else {
+                            outgoing[to].push_back(item);
+                            if (outgoing[to].size() == BatchSize)
+                                send(to);
+                        }
+                    }
+                    for (size_t to = 0; to < threads; to++) {
+                        if (!outgoing[to].empty())
+                            send(to);
+                    }
+                    // (the items pushed before each increment are visible once we read `threads`)
+                    done.fetch_add(1, std::memory_order_acq_rel);
+                    while (done.load(std::memory_order_acquire) < threads) {
+                        drain();
+                        std::this_thread::yield();
+                    }
+                    drain();
+                }
+            }
+            if (missing_threads.load())
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m omp_get_num_threads()==threads\n           In --> Sharded::route\n           [threads] " + std::to_string(threads) + "\n");
+            if (failed.load())
+                throw std::runtime_error(fail_what);
+        }
+    };
+
+}   // namespace hashtable
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <immintrin.h>
+
+#include "builtins.hpp"
+#include "huge_pages.hpp"
+
+// A bucketized cuckoo table filtered by fingerprints
+// Each key has two candidate buckets of BucketSize (8 or 16) slots: the one of its slot, reductionfn(hashfn(key)),
+// as in the other tables, and the one of Hash2. The one-byte fingerprints of a bucket are stored apart from its slots,
+// in a cache-line-aligned header, and compared with the fingerprint of the key in a single SIMD instruction: a lookup
+// only reads the slots that match. Keys that cannot be placed after MAX_KICKS
+// displacements go in a small stash, scanned by the lookups only when it is not empty.
+
+namespace hashtable {
+
+    template <class Key, class Payload, size_t BucketSize, class HashFn, class Hash2, class ReductionFn, size_t StashSize = 16>
+    class SimdCuckoo {
+        static_assert(BucketSize == 8 || BucketSize == 16);
+
+        using Mask = std::uint32_t;     // one bit per slot of a bucket
+        static constexpr std::uint8_t EMPTY = 0;
+        static constexpr size_t MAX_KICKS = 512;
+
+        struct Slot {
+            Key key;
+            Payload payload;
+        } packit;
+
+        private:
+
+        const HashFn hashfn;
+        const Hash2 hash2;
+        const ReductionFn reductionfn;
+        const size_t buckets;
+        std::vector<std::uint8_t, mem::HugePageAllocator<std::uint8_t, mem::Pages::NONE>> headers;    // cache-line aligned
+        std::vector<Slot> slots;
+        std::vector<Slot> stash;
+        std::uint64_t rng = 0x2545F4914F6CDD1Dull;     // to choose the key to kick
+
+        public:
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of slots (rounded up to a multiple of BucketSize)
+         * @param hashfn the hash function choosing the first bucket
+        */
+        explicit SimdCuckoo(const size_t& capacity, const HashFn hashfn = HashFn())
+         : hashfn(hashfn), hash2(), reductionfn(ReductionFn(capacity)), buckets(std::max<size_t>(2, (capacity + BucketSize - 1) / BucketSize)),
+           headers(buckets * BucketSize, EMPTY), slots(buckets * BucketSize) {
+            stash.reserve(StashSize);
+        };
+
+        SimdCuckoo(SimdCuckoo&&) noexcept = default;
+
+        /**
+         * Inserts a pair (key, value), displacing the keys of its buckets if both are full.
+         * @param key the key (i.e., the entry in the dataset)
+         * @param payload the correspondent value
+         * @return false iff the key was already there. Throws if both the kicks and the stash are exhausted.
+        */
+        bool insert(const Key& key, const Payload& payload) {
+            if (lookup(key).has_value())
+                return false;
+            Slot carry = {key, payload};
+            std::uint8_t fp = fingerprint(key);
+            size_t b = first_bucket(key);
+            for (size_t kick = 0; kick <= MAX_KICKS; kick++) {
+                // the first bucket of the carried key, then its second one
+                const size_t alt = (b == first_bucket(carry.key)) ? second_bucket(carry.key) : first_bucket(carry.key);
+                for (const size_t c : {b, alt}) {
+                    if (const Mask e = match(headers.data() + c * BucketSize, EMPTY)) {
+                        const size_t i = c * BucketSize + __builtin_ctz(e);
+                        headers[i] = fp;
+                        slots[i] = carry;
+                        return true;
+                    }
+                }
+                // both full: swap with a random key of the alternative bucket, which moves to its other bucket
+                const size_t i = alt * BucketSize + next_random() % BucketSize;
+                std::swap(headers[i], fp);
+                std::swap(slots[i], carry);
+                b = alt;
+            }
+            if (stash.size() == StashSize)
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m stash.size()<StashSize\n           In --> SimdCuckoo::insert\n           [StashSize] " + std::to_string(StashSize) + "\n");
+            stash.push_back(carry);
+            return true;
+        }
+
+        /**
+         * Looks for a single entry in its two buckets (and in the stash).
+         * @param key the value we are looking for
+         * @return the correspondent payload if the key was found, `std::nullopt` otherwise.
+        */
+        std::optional<Payload> lookup(const Key& key) const {
+            const size_t b1 = first_bucket(key), b2 = second_bucket(key);
+            const std::uint8_t* h1 = headers.data() + b1 * BucketSize;
+            const std::uint8_t* h2 = headers.data() + b2 * BucketSize;
+            const std::uint8_t fp = fingerprint(key);
+            for (Mask m = match(h1, fp); m; m &= m - 1) {
+                const Slot& slot = slots[b1 * BucketSize + __builtin_ctz(m)];
+                if (slot.key == key)
+                    return std::make_optional(slot.payload);
+            }
+            for (Mask m = match(h2, fp); m; m &= m - 1) {
+                const Slot& slot = slots[b2 * BucketSize + __builtin_ctz(m)];
+                if (slot.key == key)
+                    return std::make_optional(slot.payload);
+            }
+            if (unlikely(!stash.empty())) {
+                for (const Slot& slot : stash) {
+                    if (slot.key == key)
+                        return std::make_optional(slot.payload);
+                }
+            }
+            return std::nullopt;
+        }
+
+        size_t byte_size() const {
+            return sizeof(*this) + headers.size() * sizeof(std::uint8_t) + (slots.size() + stash.capacity()) * sizeof(Slot);
+        }
+        size_t stash_count() const {
+            return stash.size();
+        }
+
+        static std::string name() {
+            return "simd_cuckoo_" + std::to_string(BucketSize) + "_" + HashFn::name() + "_" + Hash2::name() + "_" + ReductionFn::name() + "_stash_" + std::to_string(StashSize);
+        }
+
+        private:
+
+        // the bucket of the slot of the key (a learned function keeps its order)
+        forceinline size_t first_bucket(const Key& key) const {
+            return std::min<size_t>(reductionfn(hashfn(key)) / BucketSize, buckets - 1);
+        }
+        // (fastrange)
+        forceinline size_t second_bucket(const Key& key) const {
+            return static_cast<size_t>((static_cast<unsigned __int128>(hash2(key)) * buckets) >> 64);
+        }
+
+        // the top 8 bits of a multiplicative hash of the key, never EMPTY
+        static forceinline std::uint8_t fingerprint(const Key& key) {
+            const std::uint8_t fp = static_cast<std::uint8_t>((static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 56);
+            return fp == EMPTY ? 1 : fp;
+        }
+
+        // the slots of the bucket whose fingerprint is `fp`
+        static forceinline Mask match(const std::uint8_t* h, const std::uint8_t fp) {
+#if defined(__SSE2__)
+            if constexpr (BucketSize == 16) {
+                const __m128i header = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h));
+                return static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(header, _mm_set1_epi8(static_cast<char>(fp)))));
+            } else {
+                const __m128i header = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(h));
+                return static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(header, _mm_set1_epi8(static_cast<char>(fp))))) & 0xFF;
+            }
+#else
+            Mask m = 0;
+            for (size_t i = 0; i < BucketSize; i++)
+                m |= Mask(h[i] == fp) << i;
+            return m;
+#endif
+        }
+
+        // xorshift64
+        forceinline std::uint64_t next_random() {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            return rng;
+        }
+    };
+
+}   // namespace hashtable
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include <hashing.hpp>
+
+#include "builtins.hpp"
+#include "reduction.hpp"
+
+// simd_hash.hpp - batched versions of the classic hash functions (MultPrime64, FibonacciPrime64, MurmurFinalizer)
+// and of the reductions (FastModulo, PowerOfTwo, NoReduction). They rely on GCC vector extensions, so the compiler emits the widest
+// 64-bit multiplies available on the machine (AVX-512, AVX2, ...).
+
+namespace simd {
+    // number of 64-bit lanes processed together (a full register)
+#if defined(__AVX512F__)
+    constexpr size_t LANES = 8;
+#else
+    constexpr size_t LANES = 4;
+#endif
+    // below this value, the double-precision modulo is not guaranteed to be exact
+    constexpr std::uint64_t MIN_VECTOR_MODULO = 1 << 16;
+
+    typedef std::uint64_t u64v __attribute__((vector_size(LANES * sizeof(std::uint64_t))));
+    typedef std::int64_t i64v __attribute__((vector_size(LANES * sizeof(std::int64_t))));
+    typedef double f64v __attribute__((vector_size(LANES * sizeof(double))));
+
+    // The families of functions that can be vectorized
+    enum class Kind {
+        SCALAR = 0,
+        MULTIPLICATIVE = 1,     // h(x) = x * constant
+        MURMUR = 2              // the 64-bit murmur3 finalizer
+    };
+    template <class HashFn>
+    constexpr Kind kind_of() {
+        if constexpr (std::is_same_v<HashFn, hashing::MultPrime64> || std::is_same_v<HashFn, hashing::FibonacciPrime64>)
+            return Kind::MULTIPLICATIVE;
+        else if constexpr (std::is_same_v<HashFn, hashing::MurmurFinalizer<std::uint64_t>>)
+            return Kind::MURMUR;
+        else return Kind::SCALAR;
+    }
+
+    // works both on scalars and on vectors
+    template <class T>
+    forceinline T fmix64(T k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    /**
+     * Computes x % N on each lane, using a double-precision reciprocal and a correction step.
+     * The estimated quotient is off by at most one as long as N >= MIN_VECTOR_MODULO.
+     * @param x the values to reduce
+     * @param N the modulo
+     * @param inv_N 1.0/N
+    */
+    forceinline u64v modulo(const u64v x, const std::uint64_t N, const double inv_N) {
+        const f64v xf = __builtin_convertvector(x, f64v);
+        const u64v q = __builtin_convertvector(xf * inv_N, u64v);
+        i64v r = (i64v)(x - q * N);
+        // r is in [-N, 2N)
+        r += (r < 0) & (std::int64_t)N;
+        r -= (r >= (std::int64_t)N) & (std::int64_t)N;
+        return (u64v)r;
+    }
+
+    /**
+     * Hashes (and reduces) arrays of keys, LANES keys at a time.
+     * Since we only know the hash functions by their type, the vector code is checked against the scalar one
+     * at construction time: if they disagree (or the function cannot be vectorized), `hash` does nothing, and the caller
+     * should use the scalar path.
+    */
+    template <class HashFn, class ReductionFn>
+    class BatchHasher {
+        public:
+            BatchHasher(const HashFn& fn, const ReductionFn& reduction, const std::uint64_t N) :
+                    reduction(reduction), N(N), inv_N(1.0 / N) {
+                verify(fn);
+            }
+            /**
+             * Hashes and reduces the first n - n%LANES entries of `data`.
+             * @param data the input keys
+             * @param out the output array (it can be the same as `data`)
+             * @param n the number of keys
+             * @return the number of hashed entries (0 if the function is not vectorized)
+            */
+            size_t hash(const std::uint64_t* data, std::uint64_t* out, const size_t n) const {
+                if constexpr (kind_of<HashFn>() == Kind::SCALAR)
+                    return 0;
+                if (!vector_hash)
+                    return 0;
+                const size_t end = n - n % LANES;
+                for (size_t i = 0; i < end; i += LANES) {
+                    u64v x;
+                    std::memcpy(&x, data + i, sizeof(u64v));
+                    u64v h = hash(x);
+                    if (vector_reduction)
+                        h = reduce(h);
+                    else {
+                        for (size_t l = 0; l < LANES; l++)
+                            h[l] = reduction(h[l]);
+                    }
+                    std::memcpy(out + i, &h, sizeof(u64v));
+                }
+                return end;
+            }
+            bool is_vectorized() const {
+                return vector_hash;
+            }
+            bool is_reduction_vectorized() const {
+                return vector_hash && vector_reduction;
+            }
+
+        private:
+            ReductionFn reduction;
+            const std::uint64_t N;
+            const double inv_N;
+            std::uint64_t multiplier = 0;
+            bool vector_hash = false;
+            bool vector_reduction = false;
+
+            forceinline u64v hash(const u64v x) const {
+                if constexpr (kind_of<HashFn>() == Kind::MULTIPLICATIVE)
+                    return x * multiplier;
+                else return fmix64(x);
+            }
+
+            forceinline u64v reduce(const u64v h) const {
+                if constexpr (std::is_same_v<ReductionFn, reduction::PowerOfTwo<std::uint64_t>>)
+                    return h & (N - 1);
+                else if constexpr (std::is_same_v<ReductionFn, reduction::NoReduction<std::uint64_t>>)
+                    return h;
+                else return modulo(h, N, inv_N);
+            }
+
+            void verify(const HashFn& fn) {
+                if constexpr (kind_of<HashFn>() == Kind::SCALAR)
+                    return;
+                // some corner cases, then a splitmix64 sequence
+                constexpr size_t TESTS = 16 * LANES;
+                const std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+                std::uint64_t tests[TESTS] = {0, 1, N - 1, N, N + 1, 2 * N - 1, max, max - 1, max - max % N, max - max % N - 1};
+                std::uint64_t state = 42;
+                for (size_t i = 10; i < TESTS; i++) {
+                    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                    tests[i] = (z ^ (z >> 31)) >> (i % 32);
+                }
+                // hash function
+                multiplier = fn(1);
+                vector_hash = true;
+                for (size_t i = 0; i < TESTS; i += LANES) {
+                    u64v x;
+                    std::memcpy(&x, tests + i, sizeof(u64v));
+                    const u64v h = hash(x);
+                    for (size_t l = 0; l < LANES; l++)
+                        vector_hash &= (h[l] == fn(tests[i + l]));
+                }
+                // reduction (the modulo is exact only for large enough N)
+                constexpr bool exact = std::is_same_v<ReductionFn, reduction::PowerOfTwo<std::uint64_t>> ||
+                        std::is_same_v<ReductionFn, reduction::NoReduction<std::uint64_t>>;
+                vector_reduction = exact || (N >= MIN_VECTOR_MODULO);
+                for (size_t i = 0; i < TESTS && vector_reduction; i += LANES) {
+                    u64v x;
+                    std::memcpy(&x, tests + i, sizeof(u64v));
+                    const u64v r = reduce(x);
+                    for (size_t l = 0; l < LANES; l++)
+                        vector_reduction &= (r[l] == reduction(tests[i + l]));
+                }
+            }
+    };
+
+}   // namespace simd
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// An order-preserving chained table
+// With a monotone hash function (e.g. MonotoneRMIHash), the keys of a bucket are all smaller than the ones of the
+// following buckets: by keeping each chain sorted, a range query scans consecutive buckets, as in a sorted array.
+
+namespace hashtable {
+
+    template <class Key, class Payload, size_t BucketSize, class HashFn, Key Sentinel = std::numeric_limits<Key>::max()>
+    class SortedChained {
+
+        static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+        struct Bucket {
+            Key keys[BucketSize];
+            Payload payloads[BucketSize];
+            size_t next = NONE;     // index of the next bucket of the chain, in `overflow`
+
+            Bucket() {
+                std::fill(keys, keys + BucketSize, Sentinel);
+            }
+        };
+
+        private:
+
+        const HashFn hashfn;            // a monotone function, with outputs in [0, capacity)
+        const size_t capacity;          // the number of slots (BucketSize per bucket)
+        std::vector<Bucket> directory;  // the first bucket of each chain
+        std::deque<Bucket> overflow;    // the other ones (a deque never moves them)
+
+        public:
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of slots, the range of the (already trained) hash function
+         * @param hashfn the monotone hash function
+        */
+        explicit SortedChained(const size_t& capacity, const HashFn hashfn)
+         : hashfn(hashfn), capacity(capacity), directory((capacity + BucketSize - 1) / BucketSize) {};
+
+        SortedChained(SortedChained&&) noexcept = default;
+
+        /**
+         * Inserts a pair (key, value) in the structure, keeping the chain sorted.
+         * @param key the key (i.e., the entry in the dataset), different from Sentinel
+         * @param payload the correspondent value
+         * @return always "true", chains grow as needed.
+        */
+        bool insert(const Key& key, const Payload& payload) {
+            Key k = key;
+            Payload p = payload;
+            Bucket* bucket = &directory[bucket_of(key)];
+            // the pair we carry is swapped with every larger key along the chain (i.e., they are shifted by one)
+            while (true) {
+                for (size_t i = 0; i < BucketSize; i++) {
+                    if (bucket->keys[i] == Sentinel) {
+                        bucket->keys[i] = k;
+                        bucket->payloads[i] = p;
+                        return true;
+                    }
+                    if (bucket->keys[i] > k) {
+                        std::swap(bucket->keys[i], k);
+                        std::swap(bucket->payloads[i], p);
+                    }
+                }
+                if (bucket->next == NONE) {
+                    bucket->next = overflow.size();
+                    overflow.emplace_back();
+                }
+                bucket = &overflow[bucket->next];
+            }
+        }
+
+        /**
+         * Looks for a single entry in the structure, stopping at the first larger key.
+         * @param key the value we are looking for
+         * @return the correspondent payload if the key was found, `std::nullopt` otherwise.
+        */
+        std::optional<Payload> lookup(const Key& key) const {
+            for (const Bucket* bucket = &directory[bucket_of(key)]; bucket != nullptr; bucket = next(bucket)) {
+                for (size_t i = 0; i < BucketSize; i++) {
+                    if (bucket->keys[i] == key)
+                        return std::make_optional(bucket->payloads[i]);
+                    if (bucket->keys[i] > key)      // (also Sentinel)
+                        return std::nullopt;
+                }
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Looks for all keys in the structure in the range [min,max], scanning the buckets from the one of min
+         * to the one of max.
+         * @param min the lower bound of the interval (included)
+         * @param max the upper bound of the interval (also included)
+         * @return an array storing all payloads whose key is included in the interval.
+        */
+        std::vector<Payload> lookup_range(const Key& min, const Key& max) const {
+            std::vector<Payload> output;
+            if (min > max)
+                return output;
+            const size_t last = bucket_of(max);
+            for (size_t b = bucket_of(min); b <= last; b++) {
+                for (const Bucket* bucket = &directory[b]; bucket != nullptr; bucket = next(bucket)) {
+                    for (size_t i = 0; i < BucketSize; i++) {
+                        const Key k = bucket->keys[i];
+                        if (k == Sentinel || k > max)
+                            goto next_chain;
+                        if (k >= min)
+                            output.push_back(bucket->payloads[i]);
+                    }
+                }
+            next_chain:;
+            }
+            return output;
+        }
+
+        static std::string name() {
+            return "sorted_chained_" + HashFn::name() + "_" + std::to_string(BucketSize);
+        }
+
+        private:
+
+        // the hash is monotone, and so is h / BucketSize
+        inline size_t bucket_of(const Key& key) const {
+            return std::min<size_t>(hashfn(key), capacity - 1) / BucketSize;
+        }
+
+        inline const Bucket* next(const Bucket* bucket) const {
+            return bucket->next == NONE ? nullptr : &overflow[bucket->next];
+        }
+    };
+
+}   // namespace hashtable
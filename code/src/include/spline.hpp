@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "builtins.hpp"
+
+// ------ coro things ------ //
+#include "coroutines/cppcoro/coroutine.hpp"
+
+#include "coroutines/prefetch.hpp"
+#include "coroutines/scheduler.hpp"
+#include "coroutines/throttler.hpp"
+#include "coroutines/chained-coro.hpp"
+// ------------------------- //
+
+// spline.hpp - a learned hash function whose parameters are chosen at runtime: an error-bounded linear spline over
+// the CDF of the keys (built with the greedy spline corridor of RadixSpline), with an optional radix table
+// to narrow down the search of the segment. Without the radix table, it is an epsilon-bounded piecewise linear model
+// searched in a single step, like a one-level PGM.
+// Like the coroutine RMI, it can hash many keys at once interleaving them with coroutines, prefetching each level
+// of the search (the radix table entry, every step of the binary search over the knots, and the final knot).
+
+namespace spline {
+
+    /**
+     * @tparam Radix whether to use the radix table
+     * @tparam MaxError the maximum error, 0 if the parameters are set at runtime (see configure)
+     * @tparam RadixBits the size of the radix table (with MaxError > 0)
+    */
+    template <class Key, bool Radix = true, size_t MaxError = 0, size_t RadixBits = 18>
+    class SplineHash {
+        static_assert(RadixBits > 0 && RadixBits <= 30);
+        public:
+            static constexpr bool RADIX = Radix;
+
+            template <class Result>
+            class HashResult;
+
+            SplineHash() = default;
+            template <class RandomIt>
+            SplineHash(const RandomIt& begin, const RandomIt& end, const size_t full_size) {
+                train(begin, end, full_size);
+            }
+
+            /**
+             * Sets the parameters of the functions trained from now on (and name()). Trained functions keep theirs.
+             * Only for runtime-configured functions (MaxError = 0).
+             * @param max_error the maximum distance (in keys) between the spline and the CDF
+             * @param radix_bits the size of the radix table (2^radix_bits entries), ignored without radix table
+            */
+            static void configure(const size_t max_error, const size_t radix_bits = 18) {
+                static_assert(MaxError == 0, "the parameters of this function are fixed");
+                if (max_error == 0 || radix_bits == 0 || radix_bits > 30)
+                    throw std::runtime_error("\033[1;91mAssertion failed\033[0m max_error>0 && 0<radix_bits<=30\n           In --> SplineHash::configure\n");
+                config_max_error = max_error;
+                config_radix_bits = radix_bits;
+            }
+
+            static std::string name() {
+                if constexpr (Radix)
+                    return "spline_coro_radix_" + std::to_string(config_radix_bits) + "_" + std::to_string(config_max_error);
+                else return "spline_coro_" + std::to_string(config_max_error);
+            }
+
+            /**
+             * Builds the spline on sorted keys.
+             * @param begin the first key
+             * @param end past the last key
+             * @param full_size operator() will extrapolate to [0, full_size)
+            */
+            template <class RandomIt>
+            void train(const RandomIt& begin, const RandomIt& end, const size_t full_size) {
+                const size_t n = std::distance(begin, end);
+                max_output = full_size - 1;
+                knot_keys.clear();
+                knots.clear();
+                if (n == 0)
+                    return;
+                scale = double(full_size) / n;
+                min_key = *begin;
+                build_corridor(begin, n);
+                if constexpr (Radix)
+                    build_radix_table(*(end - 1));
+            }
+
+            forceinline size_t operator()(const Key& key) const {
+                if (unlikely(knots.empty()))
+                    return 0;
+                const size_t i = segment(key);
+                return interpolate(knots[i], knot_keys[i], key);
+            }
+
+            template <class Result = size_t>
+            HashResult<Result> hash(Key const& key) const {
+                return HashResult<Result>{key, (*this)(key)};
+            }
+
+            // ---- the steps of operator(), for the coroutines ---- //
+            struct Knot {
+                double pos;     // position of the knot key
+                double slope;   // of the segment starting at this knot
+            };
+            size_t knot_count() const {
+                return knots.size();
+            }
+            // the radix table entry bounding the search of `key` (Radix only)
+            forceinline const std::uint32_t* radix_entry(const Key& key) const {
+                const size_t prefix = key < min_key ? 0 : std::min<size_t>((key - min_key) >> shift, radix_table.size() - 2);
+                return radix_table.data() + prefix;
+            }
+            // the knots to search for `key`, given its radix table entry
+            forceinline std::pair<size_t, size_t> search_range(const std::uint32_t* entry, const Key& key) const {
+                if (key < min_key)
+                    return {0, 0};
+                return {entry[0], entry[1]};
+            }
+            forceinline const Key* knot_key_address(const size_t i) const {
+                return knot_keys.data() + i;
+            }
+            forceinline const Knot* knot_address(const size_t i) const {
+                return knots.data() + i;
+            }
+            // the output for `key`, in the segment starting at `knot`
+            forceinline size_t interpolate(const Knot& knot, const Key knot_key, const Key& key) const {
+                const double pos = key > knot_key ? knot.pos + double(key - knot_key) * knot.slope : knot.pos;
+                return std::min<size_t>(pos * scale, max_output);
+            }
+
+            /**
+             * Compute hash value for key, using coroutines and prefetching at each level of the search.
+             *
+             * @param key
+             * @param scheduler The scheduler that is handling the different streams.
+             * @param append The lambda function that is called once the hash value is found.
+            */
+            template <typename Scheduler, typename Append>
+            hashtable_coro::LookupTask<Scheduler> hash_task(Key const key, Scheduler const& scheduler, Append append) const {
+                if (unlikely(knots.empty()))
+                    co_return append(key, 0);
+                size_t first = 0, last = knots.size();
+                if constexpr (Radix) {
+                    const std::uint32_t* entry = co_await prefetch_and_schedule_on(radix_entry(key), scheduler);
+                    std::tie(first, last) = search_range(entry, key);
+                }
+                // upper bound of key in [first, last)
+                while (first < last) {
+                    const size_t mid = first + (last - first) / 2;
+                    const Key* mid_key = co_await prefetch_and_schedule_on(knot_key_address(mid), scheduler);
+                    if (*mid_key <= key)
+                        first = mid + 1;
+                    else last = mid;
+                }
+                const size_t i = first > 0 ? first - 1 : 0;
+                const Knot* knot = co_await prefetch_and_schedule_on(knot_address(i), scheduler);
+                co_return append(key, interpolate(*knot, knot_keys[i], key));
+            }
+
+            /**
+             * Compute hash values for multiple keys, using coroutines and prefetching.
+             *
+             * @param begin_keys Begin iterator for the keys collection.
+             * @param end_keys End iterator for the keys collection.
+             * @param begin_results Begin iterator for the result array [this will contain the output]
+             * @param n_streams The number of streams to be used [minimum 1, maximum MAX_CORO]
+            */
+            template <typename BeginInputIter, typename EndInputIter, typename OutputIter, class Result = size_t>
+            forceinline void interleaved_multihash(BeginInputIter begin_keys, EndInputIter end_keys, OutputIter begin_results,
+                    std::size_t const n_streams) const {
+                StaticQueueScheduler<MAX_CORO+1> scheduler{};
+                // instantiate a throttler for this multilookup
+                Throttler throttler{scheduler, n_streams};
+                for (auto key_iter = begin_keys; key_iter != end_keys; ++key_iter) {
+                    throttler.spawn(hash_task(*key_iter, scheduler, [&begin_results](Key const& k, Result const& v) mutable {
+                        *begin_results = HashResult<Result>{k, v};
+                        ++begin_results;
+                    }));
+                }
+                // run until all lookup tasks complete
+                throttler.run();
+            }
+
+            /**
+             * Compute hash values for multiple keys, in a classic sequential manner.
+            */
+            template <typename BeginInputIter, typename EndInputIter, typename OutputIter, class Result = size_t>
+            forceinline void sequential_multihash(BeginInputIter begin_keys, EndInputIter end_keys, OutputIter begin_results) const {
+                for (auto iter = begin_keys; iter != end_keys; ++iter) {
+                    *begin_results = hash<Result>(*iter);
+                    ++begin_results;
+                }
+            }
+
+            size_t byte_size() const {
+                return sizeof(*this) + knot_keys.size() * sizeof(Key) + knots.size() * sizeof(Knot) + radix_table.size() * sizeof(std::uint32_t);
+            }
+            size_t model_count() const {
+                return knots.size();
+            }
+
+        private:
+            inline static size_t config_max_error = MaxError ? MaxError : 32;
+            inline static size_t config_radix_bits = RadixBits;
+
+            size_t max_error = config_max_error;
+            size_t radix_bits = config_radix_bits;
+            // knot keys are kept apart, since they are the ones we search
+            std::vector<Key> knot_keys;
+            std::vector<Knot> knots;
+            std::vector<std::uint32_t> radix_table;
+            Key min_key = 0;
+            size_t shift = 0;
+            double scale = 1;
+            size_t max_output = 0;
+
+            /**
+             * Greedy spline corridor: a point becomes a knot when the next one falls outside the corridor of all
+             * the lines (from the last knot) that are within max_error of every point in between.
+            */
+            template <class RandomIt>
+            void build_corridor(const RandomIt& begin, const size_t n) {
+                const double err = max_error;
+                std::vector<double> positions;
+                const auto add_knot = [&](const Key key, const double pos) {
+                    knot_keys.push_back(key);
+                    positions.push_back(pos);
+                };
+                add_knot(*begin, 0);
+                Key prev_key = *begin;
+                double prev_pos = 0;
+                // corridor limits, relative to the last knot
+                double upper_dx = 0, upper_dy = 0, lower_dx = 0, lower_dy = 0;
+                bool has_corridor = false;
+                for (size_t i = 1; i < n; i++) {
+                    const Key key = *(begin + i);
+                    if (key == prev_key)
+                        continue;
+                    const double dx = double(key - knot_keys.back());
+                    const double dy = i - positions.back();
+                    if (!has_corridor) {
+                        upper_dx = lower_dx = dx;
+                        upper_dy = dy + err;
+                        lower_dy = dy - err;
+                        has_corridor = true;
+                    } else if (dy * upper_dx > upper_dy * dx || dy * lower_dx < lower_dy * dx) {
+                        // outside of the corridor: the previous point closes the segment
+                        add_knot(prev_key, prev_pos);
+                        upper_dx = lower_dx = double(key - prev_key);
+                        upper_dy = i - prev_pos + err;
+                        lower_dy = i - prev_pos - err;
+                    } else {
+                        // narrow the corridor
+                        if ((dy + err) * upper_dx < upper_dy * dx) {
+                            upper_dx = dx;
+                            upper_dy = dy + err;
+                        }
+                        if ((dy - err) * lower_dx > lower_dy * dx) {
+                            lower_dx = dx;
+                            lower_dy = dy - err;
+                        }
+                    }
+                    prev_key = key;
+                    prev_pos = i;
+                }
+                if (knot_keys.back() != prev_key)
+                    add_knot(prev_key, prev_pos);
+
+                knots.resize(knot_keys.size());
+                for (size_t i = 0; i < knots.size(); i++) {
+                    knots[i].pos = positions[i];
+                    knots[i].slope = (i + 1 < knots.size()) ? (positions[i + 1] - positions[i]) / double(knot_keys[i + 1] - knot_keys[i]) : 0.0;
+                }
+            }
+
+            /**
+             * radix_table[p] is the first knot whose key prefix is at least p
+            */
+            void build_radix_table(const Key max_key) {
+                const size_t width = std::bit_width(static_cast<std::uint64_t>(max_key - min_key));
+                shift = width > radix_bits ? width - radix_bits : 0;
+                const size_t prefixes = (size_t(1) << radix_bits) + 2;
+                radix_table.assign(prefixes, knot_keys.size());
+                size_t p = 0;
+                for (size_t i = 0; i < knot_keys.size(); i++) {
+                    const size_t prefix = (knot_keys[i] - min_key) >> shift;
+                    while (p <= prefix)
+                        radix_table[p++] = i;
+                }
+            }
+
+            // the last knot whose key is not greater than `key` (0 if there is none)
+            forceinline size_t segment(const Key& key) const {
+                auto first = knot_keys.begin(), last = knot_keys.end();
+                if constexpr (Radix) {
+                    if (key < min_key)
+                        return 0;
+                    const size_t prefix = std::min<size_t>((key - min_key) >> shift, radix_table.size() - 2);
+                    last = knot_keys.begin() + radix_table[prefix + 1];
+                    first = knot_keys.begin() + radix_table[prefix];
+                }
+                const size_t i = std::upper_bound(first, last, key) - knot_keys.begin();
+                return i > 0 ? i - 1 : 0;
+            }
+    };
+
+    // the <key, hash> pairs of the multihash functions
+    template <class Key, bool Radix, size_t MaxError, size_t RadixBits>
+    template <class Result>
+    class SplineHash<Key, Radix, MaxError, RadixBits>::HashResult {
+        Key const* key;
+        Result value;
+
+        public:
+            HashResult() : key{nullptr}, value{} {}
+            HashResult(Key const& key_, Result const& value_) : key{&key_}, value{value_} {}
+            Key const& get_key() const {
+                return *key;
+            }
+            Result const& get_value() const {
+                return value;
+            }
+            explicit operator bool() const {
+                return (key != nullptr);
+            }
+    };
+
+}   // namespace spline
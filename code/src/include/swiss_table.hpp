@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <immintrin.h>
+
+#include "builtins.hpp"
+#include "huge_pages.hpp"
+
+// An open-addressing table probed one group of slots at a time (as Swiss tables)
+// Each slot has a control byte: EMPTY, or a 7-bit tag of its key. A lookup compares the tag of the key with the
+// GroupSize control bytes of a group at once (SSE2 for 16, AVX2 for 32), and only reads the slots that match.
+// The home group of a key is the one of its slot, reductionfn(hashfn(key)): a learned function keeps its order.
+// The tag comes from the key itself (a learned hash would leave no bits for it), the probing is linear over groups.
+
+namespace hashtable {
+
+    template <class Key, class Payload, class HashFn, class ReductionFn, size_t GroupSize = 16>
+    class SwissTable {
+        static_assert(GroupSize == 16 || GroupSize == 32);
+
+        using Mask = std::uint32_t;     // one bit per slot of a group
+        static constexpr std::uint8_t EMPTY = 0x80;
+
+        struct Slot {
+            Key key;
+            Payload payload;
+        } packit;
+
+        private:
+
+        const HashFn hashfn;
+        const ReductionFn reductionfn;
+        const size_t groups;
+        std::vector<std::uint8_t, mem::HugePageAllocator<std::uint8_t, mem::Pages::NONE>> ctrl;    // cache-line aligned
+        std::vector<Slot> slots;
+
+        public:
+
+        /**
+         * The "hashtable" compatible constructor for this class.
+         * @param capacity the number of slots (rounded up to a multiple of GroupSize)
+         * @param hashfn the hash function
+        */
+        explicit SwissTable(const size_t& capacity, const HashFn hashfn = HashFn())
+         : hashfn(hashfn), reductionfn(ReductionFn(capacity)), groups(std::max<size_t>(1, (capacity + GroupSize - 1) / GroupSize)),
+           ctrl(groups * GroupSize, EMPTY), slots(groups * GroupSize) {};
+
+        SwissTable(SwissTable&&) noexcept = default;
+
+        /**
+         * Inserts a pair (key, value) in the first group (from the home one) with an empty slot.
+         * @param key the key (i.e., the entry in the dataset)
+         * @param payload the correspondent value
+         * @return false iff the key was already there.
+        */
+        bool insert(const Key& key, const Payload& payload) {
+            const std::uint8_t t = tag(key);
+            size_t g = home_group(key);
+            for (size_t probes = 0; probes < groups; probes++) {
+                const std::uint8_t* c = ctrl.data() + g * GroupSize;
+                for (Mask m = match(c, t); m; m &= m - 1) {
+                    if (slots[g * GroupSize + ctz(m)].key == key)
+                        return false;
+                }
+                // (no deletions: the key cannot be in the following groups)
+                if (const Mask e = match_empty(c)) {
+                    const size_t i = g * GroupSize + ctz(e);
+                    ctrl[i] = t;
+                    slots[i] = {key, payload};
+                    return true;
+                }
+                g = (g + 1 == groups) ? 0 : g + 1;
+            }
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m the table is not full\n           In --> SwissTable::insert\n");
+        }
+
+        /**
+         * Looks for a single entry in the structure, up to the first group with an empty slot.
+         * @param key the value we are looking for
+         * @return the correspondent payload if the key was found, `std::nullopt` otherwise.
+        */
+        std::optional<Payload> lookup(const Key& key) const {
+            const std::uint8_t t = tag(key);
+            size_t g = home_group(key);
+            for (size_t probes = 0; probes < groups; probes++) {
+                const std::uint8_t* c = ctrl.data() + g * GroupSize;
+                for (Mask m = match(c, t); m; m &= m - 1) {
+                    const Slot& slot = slots[g * GroupSize + ctz(m)];
+                    if (slot.key == key)
+                        return std::make_optional(slot.payload);
+                }
+                if (match_empty(c))
+                    return std::nullopt;
+                g = (g + 1 == groups) ? 0 : g + 1;
+            }
+            return std::nullopt;
+        }
+
+        size_t byte_size() const {
+            return sizeof(*this) + ctrl.size() * sizeof(std::uint8_t) + slots.size() * sizeof(Slot);
+        }
+
+        static std::string name() {
+            return "swiss_" + std::to_string(GroupSize) + "_" + HashFn::name() + "_" + ReductionFn::name();
+        }
+
+        private:
+
+        forceinline size_t home_group(const Key& key) const {
+            return std::min<size_t>(reductionfn(hashfn(key)) / GroupSize, groups - 1);
+        }
+
+        // the top 7 bits of a multiplicative hash of the key
+        static forceinline std::uint8_t tag(const Key& key) {
+            return static_cast<std::uint8_t>((static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 57);
+        }
+
+        static forceinline size_t ctz(const Mask m) {
+            return __builtin_ctz(m);
+        }
+
+        // the slots of the group whose control byte is `t`
+        static forceinline Mask match(const std::uint8_t* c, const std::uint8_t t) {
+#if defined(__AVX2__)
+            if constexpr (GroupSize == 32) {
+                const __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c));
+                return static_cast<Mask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(t)))));
+            }
+#endif
+#if defined(__SSE2__)
+            if constexpr (GroupSize == 16) {
+                const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c));
+                return static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(t)))));
+            }
+#endif
+            Mask m = 0;
+            for (size_t i = 0; i < GroupSize; i++)
+                m |= Mask(c[i] == t) << i;
+            return m;
+        }
+
+        // the empty slots of the group (the only control bytes with the high bit set)
+        static forceinline Mask match_empty(const std::uint8_t* c) {
+#if defined(__AVX2__)
+            if constexpr (GroupSize == 32)
+                return static_cast<Mask>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(c))));
+#endif
+#if defined(__SSE2__)
+            if constexpr (GroupSize == 16)
+                return static_cast<Mask>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(c))));
+#endif
+            Mask m = 0;
+            for (size_t i = 0; i < GroupSize; i++)
+                m |= Mask(c[i] >> 7) << i;
+            return m;
+        }
+    };
+
+}   // namespace hashtable
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "datasets.hpp"
+#include "generic_function.hpp"
+#include "machine_context.hpp"
+#include "model_cache.hpp"
+
+// tuner.hpp - picks the size of a learned hash function for a given dataset and table.
+// The candidates (a std::tuple of function types) are trained on a block of the dataset; for each of them
+// we count the expected memory accesses of a lookup (table accesses, plus model accesses that miss in the LLC)
+// and keep the cheapest one that fits the memory budget.
+
+namespace tuner {
+    using json = nlohmann::json;
+
+    // a larger model is chosen only if it is at least this much cheaper
+    constexpr double TOLERANCE = 0.01;
+    // the size of a table slot (key + payload), to convert probing distances into cache lines
+    constexpr size_t SLOT_BYTES = 16;
+
+    enum class Table {
+        CHAINED = 0,
+        LINEAR = 1
+    };
+    inline std::string name(Table table) {
+        switch (table) {
+            case Table::LINEAR: return "linear";
+            default: return "chained";
+        }
+    }
+
+    struct Choice {
+        size_t index;                   // position of the chosen function in the candidate tuple
+        std::string function_name;
+        json trace;                     // one entry per candidate
+    };
+
+    /**
+     * Calls f.template operator()<T>(), where T is the `index`-th type of the tuple Candidates.
+    */
+    template <class Candidates, class F>
+    void with_candidate(const size_t index, F&& f) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            const bool found = ((I == index ? (f.template operator()<std::tuple_element_t<I, Candidates>>(), true) : false) || ...);
+            if (!found)
+                throw std::runtime_error("\033[1;91mAssertion failed\033[0m index < std::tuple_size_v<Candidates>\n           [index] " + std::to_string(index) + "\n");
+        }(std::make_index_sequence<std::tuple_size_v<Candidates>>{});
+    }
+
+    /**
+     * Estimates the cost of a lookup, using a function trained on the sample.
+     * @return avg. table accesses (cache lines) per lookup, colliding keys, model bytes
+    */
+    template <class HashFn, class Data>
+    std::tuple<double, size_t, size_t> evaluate(const std::vector<Data>& sample, const size_t capacity, const Table table) {
+        HashFn fn;
+        _generic_::GenericFn<HashFn>::init_fn(fn, sample.begin(), sample.end(), capacity);
+        const _generic_::GenericFn<HashFn> hash(fn, capacity);
+        size_t bytes = sizeof(HashFn);
+        if constexpr (requires { fn.byte_size(); })
+            bytes = fn.byte_size();
+
+        const size_t n = sample.size();
+        if (table == Table::LINEAR && capacity <= n)
+            throw std::runtime_error("\033[1;91mAssertion failed\033[0m capacity > sample.size() for linear probing\n           [capacity] " + std::to_string(capacity) + "\n");
+        size_t collisions = 0;
+        double accesses = 0;
+        if (table == Table::CHAINED) {
+            // a key is found after all the keys inserted before it in the same slot
+            std::vector<std::uint32_t> slots(capacity, 0);
+            for (const Data& key : sample) {
+                std::uint32_t& slot = slots[hash(key)];
+                collisions += (slot > 0);
+                accesses += 1 + slot;
+                slot++;
+            }
+        } else {
+            // the total displacement of linear probing does not depend on the insertion order
+            std::vector<bool> used(capacity, false);
+            for (const Data& key : sample) {
+                size_t pos = hash(key), distance = 0;
+                while (used[pos]) {
+                    pos = (pos + 1 == capacity) ? 0 : pos + 1;
+                    distance++;
+                }
+                used[pos] = true;
+                collisions += (distance > 0);
+                accesses += 1 + double(distance * SLOT_BYTES) / mem::CACHE_LINE;
+            }
+        }
+        return {n ? accesses / n : 0, collisions, bytes};
+    }
+
+    /**
+     * Chooses the function (among Candidates) minimizing the expected memory accesses of a lookup, on a sample
+     * of at most max_sample keys.
+     * The sample is a contiguous block from the middle of the dataset: unlike a random sample, it keeps the local gaps
+     * between keys, which is what a learned function fits. Consecutive candidates must differ by a factor 10 in model
+     * count: when the block is 10^k times smaller than the dataset, the i-th candidate is estimated with the (i-k)-th
+     * one, which keeps the same keys per model.
+     * @param ds_obj the dataset
+     * @param table the table type
+     * @param load_perc the load factor of the table
+     * @param memory_budget the maximum size of the model, in bytes
+     * @param max_sample the maximum sample size
+    */
+    template <class Candidates, class Data>
+    Choice tune(const dataset::Dataset<Data>& ds_obj, const Table table, const size_t load_perc,
+            const size_t memory_budget, const size_t max_sample) {
+        constexpr size_t COUNT = std::tuple_size_v<Candidates>;
+        const size_t n = ds_obj.get_size();
+        size_t k = 0, scale = 1;
+        while (n / scale > max_sample) {
+            k++;
+            scale *= 10;
+        }
+        const std::vector<Data>& ds = ds_obj.get_ds();
+        const size_t offset = (n - n / scale) / 2;
+        const std::vector<Data> keys(ds.begin() + offset, ds.begin() + offset + n / scale);
+        const size_t capacity = std::max<size_t>(1, keys.size() * 100 / load_perc);
+        const size_t llc = machine::llc_bytes();
+
+        Choice choice{COUNT, "", json::array()};
+        double best_cost = 0;
+        for (size_t i = 0; i < COUNT; i++) {
+            json candidate;
+            with_candidate<Candidates>(i, [&]<class HashFn>() {
+                candidate["function_name"] = HashFn::name();
+            });
+            candidate["evaluated"] = (i >= k);
+            if (i < k) {
+                // the sample is too small to estimate this candidate
+                choice.trace.push_back(candidate);
+                continue;
+            }
+            std::tuple<double, size_t, size_t> stats;
+            with_candidate<Candidates>(i - k, [&]<class HashFn>() {
+                stats = evaluate<HashFn>(keys, capacity, table);
+            });
+            const auto [accesses, collisions, sample_bytes] = stats;
+            // the model is accessed at random: the part that does not fit in the LLC costs one more access
+            const size_t model_bytes = sample_bytes * scale;
+            const double model_miss = model_bytes > llc && llc > 0 ? 1.0 - double(llc) / model_bytes : 0.0;
+            const double cost = accesses + model_miss;
+            const bool fits = (model_bytes <= memory_budget);
+            candidate["collisions"] = collisions;
+            candidate["table_accesses"] = accesses;
+            candidate["model_bytes"] = model_bytes;
+            candidate["model_llc_miss"] = model_miss;
+            candidate["cost"] = cost;
+            candidate["fits_budget"] = fits;
+            choice.trace.push_back(candidate);
+            if (fits && (choice.index == COUNT || cost < best_cost * (1 - TOLERANCE))) {
+                choice.index = i;
+                choice.function_name = candidate["function_name"];
+                best_cost = cost;
+            }
+        }
+        if (choice.index == COUNT)
+            throw std::runtime_error("\033[1;91mError\033[0m no candidate fits the memory budget\n           [memory_budget] " + std::to_string(memory_budget) + "\n");
+        return choice;
+    }
+
+    /**
+     * Same as tune(), but each configuration is tuned only once per process.
+     * @return the choice, and whether it was computed by this call
+    */
+    template <class Candidates, class Data>
+    std::pair<Choice, bool> tune_once(const dataset::Dataset<Data>& ds_obj, const Table table, const size_t load_perc,
+            const size_t memory_budget, const size_t max_sample) {
+        static std::map<std::string, Choice> choices;
+        const std::vector<Data>& ds = ds_obj.get_ds();
+        const std::string key = std::string(typeid(Candidates).name()) + ":" + std::to_string(model_cache::fingerprint(ds.begin(), ds.end()))
+                + ":" + name(table) + ":" + std::to_string(load_perc) + ":" + std::to_string(memory_budget) + ":" + std::to_string(max_sample);
+        auto it = choices.find(key);
+        if (it != choices.end())
+            return {it->second, false};
+        return {choices.emplace(key, tune<Candidates>(ds_obj, table, load_perc, memory_budget, max_sample)).first->second, true};
+    }
+
+}   // namespace tuner
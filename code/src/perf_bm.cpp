@@ -32,7 +32,7 @@ void show_usage() {
     std::cout << "  -f, --filter FILTER        The type of benchmark we want to execute. Options = probe,join" << std::endl;
     std::cout << "  -D, --dataset DATASET      Dataset that will be used. Options = gap10,fb" << std::endl;
     std::cout << "  -F, --function HASH_FN     Function to use. Options = rmi,mult,mwhc" << std::endl;
-    std::cout << "  -T, --table TABLE          Table to use. Options = chain,linear,cuckoo" << std::endl;
+    std::cout << "  -T, --table TABLE          Table to use. Options = chain,linear,cuckoo,swiss" << std::endl;
     std::cout << "  -D, --probe DISTRIBUTION   Distribution used to probe. Options = uniform,80-20 (default: uniform)" << std::endl;
     std::cout << "  -h, --help                 Display this help message\n" << std::endl;
 }
@@ -94,7 +94,7 @@ int pars_args(const int& argc, char* const* const& argv) {
         if (arg == "--table_name" || arg == "-T") {
             if (i + 1 < argc) {
                 table_name = argv[i + 1];
-                if (table_name != "chain" && table_name != "linear" && table_name != "cuckoo") {
+                if (table_name != "chain" && table_name != "linear" && table_name != "cuckoo" && table_name != "swiss") {
                     std::cerr << "Error: Unknown option for --table_name -> " << table_name << std::endl;
                     return 2;
                 }
@@ -174,7 +174,8 @@ int main(int argc, char* argv[]) {
         probe_type = bm::ProbeType::PARETO_80_20;
 
     // Create a JsonWriter instance (for the output file)
-    JsonOutput writer(".", argv[0], "tmp");
+    // (skip the machine calibration, this output file is temporary)
+    JsonOutput writer(".", argv[0], "tmp", 1, /*calibrate*/ false);
     // Open the output file in append mode
     output_file.open(filename, std::ios_base::app);
     if (!output_file.is_open()) {
@@ -200,6 +201,8 @@ int main(int argc, char* argv[]) {
                     bm::probe_throughput<RMIHash_10, LinearTable<RMIHash_10>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
                 if (table_name == "cuckoo")
                     bm::probe_throughput<RMIHash_10, CuckooTable<RMIHash_10>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
+                if (table_name == "swiss")
+                    bm::probe_throughput<RMIHash_10, SwissTable<RMIHash_10>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
             }
             if (ds_name == "fb") {
                 if (table_name == "chain")
@@ -208,6 +211,8 @@ int main(int argc, char* argv[]) {
                     bm::probe_throughput<RMIHash_10M, LinearTable<RMIHash_10M>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
                 if (table_name == "cuckoo")
                     bm::probe_throughput<RMIHash_10M, CuckooTable<RMIHash_10M>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
+                if (table_name == "swiss")
+                    bm::probe_throughput<RMIHash_10M, SwissTable<RMIHash_10M>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
             }
         }
         // MultiPrime
@@ -218,6 +223,8 @@ int main(int argc, char* argv[]) {
                 bm::probe_throughput<MultPrime64, LinearTable<MultPrime64>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
             if (table_name == "cuckoo")
                 bm::probe_throughput<MultPrime64, CuckooTable<MultPrime64>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
+            if (table_name == "swiss")
+                bm::probe_throughput<MultPrime64, SwissTable<MultPrime64>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
         }
         // MWHC
         if (h_fun_name == "mwhc") {
@@ -227,6 +234,8 @@ int main(int argc, char* argv[]) {
                 bm::probe_throughput<MWHC, LinearTable<MWHC>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
             if (table_name == "cuckoo")
                 bm::probe_throughput<MWHC, CuckooTable<MWHC>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
+            if (table_name == "swiss")
+                bm::probe_throughput<MWHC, SwissTable<MWHC>>(ds, writer, LOAD_PERC, probe_type, perf_config, output_file);
         }
     }
     
@@ -241,6 +250,8 @@ int main(int argc, char* argv[]) {
                     bm::join_helper<RMIHash_1k, LinearTable<RMIHash_1k>>(ds, writer, perf_config, output_file);
                 if (table_name == "cuckoo")
                     bm::join_helper<RMIHash_1k, CuckooTable<RMIHash_1k>>(ds, writer, perf_config, output_file);
+                if (table_name == "swiss")
+                    bm::join_helper<RMIHash_1k, SwissTable<RMIHash_1k>>(ds, writer, perf_config, output_file);
             }
             if (ds_name == "fb") {
                 if (table_name == "chain")
@@ -249,6 +260,8 @@ int main(int argc, char* argv[]) {
                     bm::join_helper<RMIHash_1M, LinearTable<RMIHash_1M>>(ds, writer, perf_config, output_file);
                 if (table_name == "cuckoo")
                     bm::join_helper<RMIHash_1M, CuckooTable<RMIHash_1M>>(ds, writer, perf_config, output_file);
+                if (table_name == "swiss")
+                    bm::join_helper<RMIHash_1M, SwissTable<RMIHash_1M>>(ds, writer, perf_config, output_file);
             }
         }
         // MultiPrime
@@ -259,6 +272,8 @@ int main(int argc, char* argv[]) {
                 bm::join_helper<MultPrime64, LinearTable<MultPrime64>>(ds, writer, perf_config, output_file);
             if (table_name == "cuckoo")
                 bm::join_helper<MultPrime64, CuckooTable<MultPrime64>>(ds, writer, perf_config, output_file);
+            if (table_name == "swiss")
+                bm::join_helper<MultPrime64, SwissTable<MultPrime64>>(ds, writer, perf_config, output_file);
         }
         // MWHC
         if (h_fun_name == "mwhc") {
@@ -268,6 +283,8 @@ int main(int argc, char* argv[]) {
                 bm::join_helper<MWHC, LinearTable<MWHC>>(ds, writer, perf_config, output_file);
             if (table_name == "cuckoo")
                 bm::join_helper<MWHC, CuckooTable<MWHC>>(ds, writer, perf_config, output_file);
+            if (table_name == "swiss")
+                bm::join_helper<MWHC, SwissTable<MWHC>>(ds, writer, perf_config, output_file);
         }
     }
     return 0;